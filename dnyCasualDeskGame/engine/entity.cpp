@@ -19,12 +19,40 @@ namespace Entity {
 	Scripting::CScriptInt* pScrReference = nullptr;
 	CToolMgr* _pGameToolMgrInstance = nullptr;
 	CScriptedEntsMgr oScriptedEntMgr;
+	asITypeInfo* pEntityArrayType = nullptr;
 	DxRenderer::d3dfont_s* pDefaultFont = nullptr;
 	Console::CConsole* pConReference = nullptr;
 	CConVarManager oConVarMgr;
+	CCollisionMaskCache oCollisionMaskCache;
+	CMoveOrderMgr oMoveOrderMgr;
+	const char* const aszEntityMethods[EM_COUNT] = {
+		"void OnSpawn(const Vector& in)",
+		"void OnRelease()",
+		"void OnProcess()",
+		"void OnDraw()",
+		"void OnDrawOnTop()",
+		"bool DoUserCleaning()",
+		"DamageType IsDamageable()",
+		"void OnDamage(DamageValue dv)",
+		"void OnContact(IScriptedEntity@ pOther, ContactPhase ePhase)",
+		"Model& GetModel()",
+		"Vector& GetPosition()",
+		"float GetRotation()",
+		"bool IsMovable()",
+		"Vector& GetSelectionSize()",
+		"DamageValue GetDamageValue()",
+		"bool NeedsRemoval()",
+		"string GetName()",
+		"void MoveTo(const Vector& in vec)"
+	};
+	Scripting::si_method_table_s oNoEntityMethods = { aszEntityMethods, std::vector<asIScriptFunction*>(EM_COUNT, nullptr) };
 	std::wstring wszBasePath;
+	float flInterpolationAlpha = 0.0f;
 
 	void SetBasePath(const std::wstring& path) { wszBasePath = path; }
+	void SetEntityBudget(size_t uiEntityCount) { oScriptedEntMgr.SetBudget(uiEntityCount); }
+	void SetTickRate(unsigned int uiTickRate) { oScriptedEntMgr.SetTickRate(uiTickRate); }
+	void SetInterpolationAlpha(float flAlpha) { flInterpolationAlpha = flAlpha; }
 
 	namespace APIFuncs {
 		void Print(const std::string& in)
@@ -154,6 +182,127 @@ namespace Entity {
 			return ((oEntityTrace.IsEmpty()) ? nullptr : oEntityTrace.EntityObject(0));
 		}
 
+		asIScriptObject* EntityTraceEx(const Vector& vStart, const Vector& vEnd, asIScriptObject* pIgnoredEnt, int& iDistance)
+		{
+			CEntityTrace oEntityTrace(vStart, vEnd, pIgnoredEnt);
+			iDistance = ((oEntityTrace.IsEmpty()) ? -1 : oEntityTrace.HitDistance());
+			return ((oEntityTrace.IsEmpty()) ? nullptr : oEntityTrace.EntityObject(0));
+		}
+
+		CScriptArray* CreateEntityArray(const std::vector<size_t>& vEntities)
+		{
+			CScriptArray* pArray = CScriptArray::Create(pEntityArrayType, (asUINT)vEntities.size());
+			if (!pArray)
+				return nullptr;
+
+			for (size_t i = 0; i < vEntities.size(); i++) {
+				asIScriptObject* pObject = oScriptedEntMgr.GetEntityHandle(vEntities[i]);
+				pArray->SetValue((asUINT)i, &pObject);
+			}
+
+			return pArray;
+		}
+
+		CScriptArray* QueryRadius(const Vector& vOrigin, int iRadius, bool bDamageableOnly, const std::string& szExcludeName, asIScriptObject* pIgnoredEnt)
+		{
+			std::vector<size_t> vEntities;
+			oScriptedEntMgr.QueryRadius(vOrigin, iRadius, oScriptedEntMgr.MakeFilter(bDamageableOnly, szExcludeName, pIgnoredEnt), vEntities);
+			return CreateEntityArray(vEntities);
+		}
+
+		CScriptArray* QueryBox(const Vector& vMin, const Vector& vMax, bool bDamageableOnly, const std::string& szExcludeName, asIScriptObject* pIgnoredEnt)
+		{
+			std::vector<size_t> vEntities;
+			oScriptedEntMgr.QueryBox(vMin, vMax, oScriptedEntMgr.MakeFilter(bDamageableOnly, szExcludeName, pIgnoredEnt), vEntities);
+			return CreateEntityArray(vEntities);
+		}
+
+		CScriptArray* ApplyRadialDamage(const Vector& vCenter, int iRadius, CScriptedEntity::DamageValue dvDamage, float flFalloff, const std::string& szExcludeName, bool bReturnVictims)
+		{
+			if (!bReturnVictims) {
+				oScriptedEntMgr.ApplyRadialDamage(vCenter, iRadius, dvDamage, flFalloff, oScriptedEntMgr.MakeFilter(true, szExcludeName, nullptr), nullptr);
+				return nullptr;
+			}
+
+			std::vector<EntityHandle> vVictims;
+			oScriptedEntMgr.ApplyRadialDamage(vCenter, iRadius, dvDamage, flFalloff, oScriptedEntMgr.MakeFilter(true, szExcludeName, nullptr), &vVictims);
+
+			//Victims may have been removed by now, so only valid ones are returned
+			std::vector<size_t> vEntities;
+			for (size_t i = 0; i < vVictims.size(); i++) {
+				size_t uiEntity = oScriptedEntMgr.GetEntityIndex(vVictims[i]);
+				if (uiEntity != SI_INVALID_ID)
+					vEntities.push_back(uiEntity);
+			}
+
+			return CreateEntityArray(vEntities);
+		}
+
+		asIScriptObject* FindNearest(const Vector& vOrigin, int iMaxRange, const std::string& szExcludeName, bool bDamageableOnly)
+		{
+			std::vector<size_t> vEntities;
+			oScriptedEntMgr.FindNearest(vOrigin, iMaxRange, oScriptedEntMgr.MakeFilter(bDamageableOnly, szExcludeName, nullptr), 1, vEntities);
+			return ((vEntities.size()) ? oScriptedEntMgr.GetEntityHandle(vEntities[0]) : nullptr);
+		}
+
+		CScriptArray* FindNearestK(const Vector& vOrigin, int iMaxRange, const std::string& szExcludeName, bool bDamageableOnly, asUINT uiCount)
+		{
+			std::vector<size_t> vEntities;
+			oScriptedEntMgr.FindNearest(vOrigin, iMaxRange, oScriptedEntMgr.MakeFilter(bDamageableOnly, szExcludeName, nullptr), uiCount, vEntities);
+			return CreateEntityArray(vEntities);
+		}
+
+		void GetEntityPoolStats(pool_stats_s& out)
+		{
+			out = oScriptedEntMgr.PoolStats();
+		}
+
+		float GetInterpolationAlpha(void)
+		{
+			return flInterpolationAlpha;
+		}
+
+		bool SetCollisionLayers(asIScriptObject* pEntity, asUINT uiCategory, asUINT uiMask)
+		{
+			return oScriptedEntMgr.SetCollisionLayers(pEntity, uiCategory, uiMask);
+		}
+
+		bool GetFlowDirection(asIScriptObject* pEntity, const Vector& vPosition, float& flAngle)
+		{
+			return oMoveOrderMgr.GetDirection(oScriptedEntMgr.GetHandle(pEntity), vPosition, flAngle);
+		}
+
+		bool SetNextThink(asIScriptObject* pEntity, asUINT uiMilliseconds)
+		{
+			return oScriptedEntMgr.SetNextThink(pEntity, uiMilliseconds);
+		}
+
+		bool SetLodPolicy(asIScriptObject* pEntity, bool bEnabled, asUINT uiRemoveDelay, asUINT uiProcessInterval)
+		{
+			return oScriptedEntMgr.SetLodPolicy(pEntity, bEnabled, uiRemoveDelay, uiProcessInterval);
+		}
+
+		CScriptArray* GetEntitiesByName(const std::string& szName)
+		{
+			const std::vector<CScriptedEntity*>* pList = oScriptedEntMgr.GetEntitiesByName(szName);
+
+			CScriptArray* pArray = CScriptArray::Create(pEntityArrayType, (pList) ? (asUINT)pList->size() : 0);
+			if ((!pArray) || (!pList))
+				return pArray;
+
+			for (size_t i = 0; i < pList->size(); i++) {
+				asIScriptObject* pObject = (*pList)[i]->Object();
+				pArray->SetValue((asUINT)i, &pObject);
+			}
+
+			return pArray;
+		}
+
+		asUINT CountByName(const std::string& szName)
+		{
+			return (asUINT)oScriptedEntMgr.CountByName(szName);
+		}
+
 		bool Ent_IsValid(asIScriptObject* pEntity)
 		{
 			return oScriptedEntMgr.IsValidEntity(pEntity);
@@ -255,9 +404,9 @@ namespace Entity {
 
 	CToolMgr* Initialize(DxRenderer::CDxRenderer* pGfx, DxSound::CDxSound* pSnd, Scripting::CScriptInt* pScr, Console::CConsole* pCns)
 	{
-		//Initialize entity scripting
+		//Initialize entity scripting. Renderer and sound are optional, so that entities can be processed headless, e.g. by the benchmarks
 
-		if ((!pGfx) || (!pSnd) || (!pScr))
+		if (!pScr)
 			return nullptr;
 		
 		//Store references
@@ -267,9 +416,11 @@ namespace Entity {
 		pConReference = pCns;
 
 		//Create default font
-		pDefaultFont = pGfxReference->LoadFont(L"Verdana", 7, 15);
-		if (!pDefaultFont)
-			return nullptr;
+		if (pGfxReference) {
+			pDefaultFont = pGfxReference->LoadFont(L"Verdana", 7, 15);
+			if (!pDefaultFont)
+				return nullptr;
+		}
 
 		//Registration macros
 		#define REG_ENUM(n, h) h = pScrReference->RegisterEnumeration(n); if (h == SI_INVALID_ID) { return nullptr; }
@@ -304,6 +455,10 @@ namespace Entity {
 		ADD_ENUM(hEnum, "DAMAGEABLE_NO", DAMAGEABLE_NO);
 		ADD_ENUM(hEnum, "DAMAGEABLE_ALL", DAMAGEABLE_ALL);
 		ADD_ENUM(hEnum, "DAMAGEABLE_NOTSQUAD", DAMAGEABLE_NOTSQUAD);
+		REG_ENUM("ContactPhase", hEnum);
+		ADD_ENUM(hEnum, "CONTACT_BEGIN", CONTACT_BEGIN);
+		ADD_ENUM(hEnum, "CONTACT_STAY", CONTACT_STAY);
+		ADD_ENUM(hEnum, "CONTACT_END", CONTACT_END);
 		REG_ENUM("FileSeekWay", hEnum);
 		ADD_ENUM(hEnum, "SEEKW_BEGIN", CFileReader::SEEKW_BEGIN);
 		ADD_ENUM(hEnum, "SEEKW_CURRENT", CFileReader::SEEKW_CURRENT);
@@ -325,6 +480,12 @@ namespace Entity {
 		ADD_STRUCT("int iCursorWidth", asOFFSET(CToolMgr::ToolInfo, iCursorWidth), hStructs);
 		ADD_STRUCT("int iCursorHeight", asOFFSET(CToolMgr::ToolInfo, iCursorHeight), hStructs);
 		ADD_STRUCT("uint32 uiTriggerDelay", asOFFSET(CToolMgr::ToolInfo, uiTriggerDelay), hStructs);
+		REG_STRUCT("EntityPoolStats", sizeof(Entity::pool_stats_s), hStructs);
+		ADD_STRUCT("size_t uiLive", asOFFSET(Entity::pool_stats_s, uiLive), hStructs);
+		ADD_STRUCT("size_t uiPeak", asOFFSET(Entity::pool_stats_s, uiPeak), hStructs);
+		ADD_STRUCT("size_t uiCapacity", asOFFSET(Entity::pool_stats_s, uiCapacity), hStructs);
+		ADD_STRUCT("size_t uiAllocations", asOFFSET(Entity::pool_stats_s, uiAllocations), hStructs);
+		ADD_STRUCT("size_t uiHeapAllocations", asOFFSET(Entity::pool_stats_s, uiHeapAllocations), hStructs);
 		REG_STRUCT("GameKeys", sizeof(Entity::game_keys_s), hStructs);
 		ADD_STRUCT("int vkTrigger", asOFFSET(Entity::game_keys_s, vkTrigger), hStructs);
 		ADD_STRUCT("int vkClean", asOFFSET(Entity::game_keys_s, vkClean), hStructs);
@@ -420,6 +581,9 @@ namespace Entity {
 		ADD_CLASSF("SpriteHandle Handle()", asMETHOD(CModel, Sprite), hClasses);
 		ADD_CLASSF("const Vector& GetCenter() const", asMETHOD(CModel, Center), hClasses);
 		ADD_CLASSF("BoundingBox& GetBBox()", asMETHOD(CModel, BBox), hClasses);
+		ADD_CLASSF("bool EnablePixelCollision(uint8 alphaThreshold, int scale)", asMETHOD(CModel, EnablePixelCollision), hClasses);
+		ADD_CLASSF("void DisablePixelCollision()", asMETHOD(CModel, DisablePixelCollision), hClasses);
+		ADD_CLASSF("void SetFrame(int iFrame)", asMETHOD(CModel, SetFrame), hClasses);
 		REG_CLASSV("Timer", sizeof(CTimer), hClasses);
 		ADD_CLASSB(asBEHAVE_CONSTRUCT, "void f()", asMETHOD(CTimer, Construct), hClasses);
 		ADD_CLASSB(asBEHAVE_DESTRUCT, "void f()", asMETHOD(CTimer, Destruct), hClasses);
@@ -501,6 +665,20 @@ namespace Entity {
 			{ "size_t Ent_GetEntityCount()", &APIFuncs::GetEntityCount },
 			{ "IScriptedEntity@+ Ent_GetEntityHandle(size_t uiEntityId)", &APIFuncs::GetEntityHandle },
 			{ "IScriptedEntity@+ Ent_TraceLine(const Vector&in vStart, const Vector&in vEnd, IScriptedEntity@+ pIgnoredEnt)", &APIFuncs::EntityTrace },
+			{ "IScriptedEntity@+ Ent_TraceLineEx(const Vector&in vStart, const Vector&in vEnd, IScriptedEntity@+ pIgnoredEnt, int &out iDistance)", &APIFuncs::EntityTraceEx },
+			{ "array<IScriptedEntity@>@ Ent_QueryRadius(const Vector&in vOrigin, int iRadius, bool bDamageableOnly, const string&in szExcludeName, IScriptedEntity@+ pIgnoredEnt)", &APIFuncs::QueryRadius },
+			{ "array<IScriptedEntity@>@ Ent_ApplyRadialDamage(const Vector&in vCenter, int iRadius, DamageValue dvDamage, float flFalloff, const string&in szExcludeName, bool bReturnVictims)", &APIFuncs::ApplyRadialDamage },
+			{ "array<IScriptedEntity@>@ Ent_QueryBox(const Vector&in vMin, const Vector&in vMax, bool bDamageableOnly, const string&in szExcludeName, IScriptedEntity@+ pIgnoredEnt)", &APIFuncs::QueryBox },
+			{ "IScriptedEntity@+ Ent_FindNearest(const Vector&in vOrigin, int iMaxRange, const string&in szExcludeName, bool bDamageableOnly)", &APIFuncs::FindNearest },
+			{ "array<IScriptedEntity@>@ Ent_FindNearestK(const Vector&in vOrigin, int iMaxRange, const string&in szExcludeName, bool bDamageableOnly, uint uiCount)", &APIFuncs::FindNearestK },
+			{ "void Ent_GetPoolStats(EntityPoolStats &out)", &APIFuncs::GetEntityPoolStats },
+			{ "float Ent_GetInterpolationAlpha()", &APIFuncs::GetInterpolationAlpha },
+			{ "bool Ent_SetCollisionLayers(IScriptedEntity@ pEntity, uint32 uiCategory, uint32 uiMask)", &APIFuncs::SetCollisionLayers },
+			{ "bool Ent_GetFlowDirection(IScriptedEntity@ pEntity, const Vector&in vPos, float &out flAngle)", &APIFuncs::GetFlowDirection },
+			{ "bool Ent_SetNextThink(IScriptedEntity@ pEntity, uint32 uiMilliseconds)", &APIFuncs::SetNextThink },
+			{ "bool Ent_SetLodPolicy(IScriptedEntity@ pEntity, bool bEnabled, uint32 uiRemoveDelay, uint32 uiProcessInterval)", &APIFuncs::SetLodPolicy },
+			{ "array<IScriptedEntity@>@ Ent_GetEntitiesByName(const string&in szName)", &APIFuncs::GetEntitiesByName },
+			{ "uint Ent_CountByName(const string&in szName)", &APIFuncs::CountByName },
 			{ "bool Ent_IsValid(IScriptedEntity@ pEntity)", &APIFuncs::Ent_IsValid },
 			{ "size_t Ent_GetId(IScriptedEntity@ pEntity)", &APIFuncs::Ent_GetId },
 			{ "bool Util_ListSprites(const string& in, FuncFileListing @cb)", &APIFuncs::ListSprites },
@@ -512,6 +690,11 @@ namespace Entity {
 			if (!pScrReference->RegisterFunction(sGameAPIFunctions[i].szDefinition, sGameAPIFunctions[i].pFunction))
 				return nullptr;
 		}
+
+		//Obtain type of entity handle arrays returned by queries
+		pEntityArrayType = pScrReference->GetTypeInfo("array<IScriptedEntity@>", false);
+		if (!pEntityArrayType)
+			return nullptr;
 		
 		return new CToolMgr;
 	}
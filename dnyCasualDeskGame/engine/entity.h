@@ -18,6 +18,7 @@
 #include "scriptint.h"
 #include "utils.h"
 #include "console.h"
+#include "rectkernels.h"
 
 /* Entity (vectors, tools, scripted ents, models, ...) management environment */
 namespace Entity {
@@ -31,6 +32,14 @@ namespace Entity {
 	extern std::wstring wszBasePath;
 
 	enum DamageType { DAMAGEABLE_NO = 0, DAMAGEABLE_ALL, DAMAGEABLE_NOTSQUAD };
+	enum ContactPhase { CONTACT_BEGIN = 0, CONTACT_STAY, CONTACT_END };
+
+	#define ENT_LAYER_DEFAULT 0x00000001
+	#define ENT_LAYER_ALL 0xFFFFFFFF
+	#define ENT_SQUAD_LAYERS 0x7FFFFFFF00000000ULL //Snapshot layers above the script layers, one per squad of DAMAGEABLE_NOTSQUAD entities
+	#define ENT_SQUAD_LAYER_NONE 0x8000000000000000ULL //Squad layer of all other entities
+	#define ENT_SQUAD_LAYER_FIRST 32
+	#define ENT_SQUAD_LAYER_COUNT 31
 
 	struct game_keys_s {
 		int vkTrigger, vkClean, vkMenu, vkScrollUp, vkScrollDown, vkTeamSelect, vkConsole, vkTakeScreen, vkKey1, vkKey2, vkKey3, vkKey4, vkKey5, vkKey6, vkKey7, vkKey8, vkKey9, vkKey0, vkExit;
@@ -338,6 +347,8 @@ namespace Entity {
 	};
 
 	/* Bounding Box handler */
+	#define ENT_BBOX_INLINE_ITEMS 8 //Items stored inside the object before moving to the heap
+	#define ENT_BBOX_KERNEL_MIN_ITEMS 4 //Item count from which on the batched rectangle kernels are used
 	class CBoundingBox {
 	private:
 		struct bbox_item_s {
@@ -345,119 +356,242 @@ namespace Entity {
 			Vector size;
 		};
 
-		std::vector<bbox_item_s>* m_pvBBoxItems;
-
-		void Release(void)
+		//Item rectangles are stored as columns (min x, min y, max x, max y), each m_uiCapacity long.
+		//Boxes with up to ENT_BBOX_INLINE_ITEMS items are kept inline, larger ones move to the heap
+		int m_aiInline[4 * ENT_BBOX_INLINE_ITEMS];
+		std::vector<int> m_vOverflow;
+		size_t m_uiCount;
+		size_t m_uiCapacity;
+		Vector m_vUnionMin;
+		Vector m_vUnionMax;
+
+		inline const int* Data(void) const { return (this->m_vOverflow.size()) ? this->m_vOverflow.data() : this->m_aiInline; }
+		inline int* Data(void) { return (this->m_vOverflow.size()) ? this->m_vOverflow.data() : this->m_aiInline; }
+		inline const int* MinX(void) const { return this->Data(); }
+		inline const int* MinY(void) const { return this->Data() + this->m_uiCapacity; }
+		inline const int* MaxX(void) const { return this->Data() + this->m_uiCapacity * 2; }
+		inline const int* MaxY(void) const { return this->Data() + this->m_uiCapacity * 3; }
+
+		void Grow(void)
 		{
-			//Clear data
+			//Double the capacity and move the columns to the heap
 
-			if (!this->m_pvBBoxItems)
-				return;
-			
-			this->m_pvBBoxItems->clear();
+			size_t uiCapacity = this->m_uiCapacity * 2;
+			std::vector<int> vData(uiCapacity * 4);
+
+			for (size_t i = 0; i < 4; i++) {
+				memcpy(&vData[i * uiCapacity], this->Data() + i * this->m_uiCapacity, this->m_uiCount * sizeof(int));
+			}
 
-			delete this->m_pvBBoxItems;
+			this->m_vOverflow.swap(vData);
+			this->m_uiCapacity = uiCapacity;
 		}
 
-		bool IsItemCollided(const Vector& vMyAbsPos, const Vector& vRefAbsPos, const bbox_item_s& rBBoxItem) const
+		bool ContainsPoint(int x, int y) const
 		{
-			//Check if bbox item collides with any of own items
+			//Check if the point (relative to the owner position) lies inside any item, borders included.
+			//The loop has no early exit so that it can be vectorized
 
-			if (!this->m_pvBBoxItems)
+			if ((x < this->m_vUnionMin[0]) || (x > this->m_vUnionMax[0]) || (y < this->m_vUnionMin[1]) || (y > this->m_vUnionMax[1]))
 				return false;
-			
-			for (size_t i = 0; i < this->m_pvBBoxItems->size(); i++) { //Iterate through items
-				bbox_item_s item = (*this->m_pvBBoxItems)[i];
-				//Check if bbox item is inside current iterated item
-				if (((vRefAbsPos[0] + rBBoxItem.pos[0] >= vMyAbsPos[0] + (*this->m_pvBBoxItems)[i].pos[0]) && (vRefAbsPos[0] + rBBoxItem.pos[0] <= vMyAbsPos[0] + (*this->m_pvBBoxItems)[i].pos[0] + (*this->m_pvBBoxItems)[i].size[0])) && ((vRefAbsPos[1] + rBBoxItem.pos[1] >= vMyAbsPos[1] + (*this->m_pvBBoxItems)[i].pos[1]) && (vRefAbsPos[1] + rBBoxItem.pos[1] <= vMyAbsPos[1] + (*this->m_pvBBoxItems)[i].pos[1] + (*this->m_pvBBoxItems)[i].size[1]))) {
-					return true;
-				}
+
+			//A single item is its own enclosing rectangle, which is the case for all shipped models
+			if (this->m_uiCount == 1)
+				return true;
+
+			//Use the batched kernels where it pays off
+			if (this->m_uiCount >= ENT_BBOX_KERNEL_MIN_ITEMS) {
+				RectKernels::rect_columns_s sRects = { this->MinX(), this->MinY(), this->MaxX(), this->MaxY(), this->m_uiCount };
+				return RectKernels::AnyContainsPoint(sRects, x, y);
 			}
 
-			return false;
+			const int* piMinX = this->MinX();
+			const int* piMinY = this->MinY();
+			const int* piMaxX = this->MaxX();
+			const int* piMaxY = this->MaxY();
+
+			int iHit = 0;
+			for (size_t i = 0; i < this->m_uiCount; i++) {
+				iHit |= (x >= piMinX[i]) & (x <= piMaxX[i]) & (y >= piMinY[i]) & (y <= piMaxY[i]);
+			}
+
+			return iHit != 0;
 		}
 	public:
-		CBoundingBox() {}
-		~CBoundingBox() { this->Release(); }
+		CBoundingBox() : m_uiCount(0), m_uiCapacity(ENT_BBOX_INLINE_ITEMS) {}
+		CBoundingBox(const CBoundingBox& ref) : m_uiCount(0), m_uiCapacity(ENT_BBOX_INLINE_ITEMS) { *this = ref; }
+		~CBoundingBox() {}
 
 		bool Alloc(void)
 		{
-			//Allocate memory for vector
-
-			this->m_pvBBoxItems = new std::vector<bbox_item_s>;
+			//Storage is part of the object, kept for compatibility
 
-			return this->m_pvBBoxItems != nullptr;
+			return true;
 		}
 
 		void AddBBoxItem(const Vector& pos, const Vector& size)
 		{
 			//Add bounding box item
 
-			if (!this->m_pvBBoxItems)
-				return;
-
-			//Setup data
-			bbox_item_s sItem;
-			sItem.pos = pos;
-			sItem.size = size;
+			if (this->m_uiCount == this->m_uiCapacity)
+				this->Grow();
+
+			int iMaxX = pos[0] + size[0];
+			int iMaxY = pos[1] + size[1];
+
+			int* piData = this->Data();
+			piData[this->m_uiCount] = pos[0];
+			piData[this->m_uiCapacity + this->m_uiCount] = pos[1];
+			piData[this->m_uiCapacity * 2 + this->m_uiCount] = iMaxX;
+			piData[this->m_uiCapacity * 3 + this->m_uiCount] = iMaxY;
+
+			//Extend the rectangle enclosing all items
+			if (!this->m_uiCount) {
+				this->m_vUnionMin = Vector(pos[0], pos[1]);
+				this->m_vUnionMax = Vector(iMaxX, iMaxY);
+			} else {
+				if (pos[0] < this->m_vUnionMin[0]) this->m_vUnionMin[0] = pos[0];
+				if (pos[1] < this->m_vUnionMin[1]) this->m_vUnionMin[1] = pos[1];
+				if (iMaxX > this->m_vUnionMax[0]) this->m_vUnionMax[0] = iMaxX;
+				if (iMaxY > this->m_vUnionMax[1]) this->m_vUnionMax[1] = iMaxY;
+			}
 
-			//Add to list
-			this->m_pvBBoxItems->push_back(sItem);
+			this->m_uiCount++;
 		}
 
-		bool IsCollided(const Vector& vMyAbsPos, const Vector& vRefAbsPos, const CBoundingBox& roBBox)
+		bool IsCollided(const Vector& vMyAbsPos, const Vector& vRefAbsPos, const CBoundingBox& roBBox) const
 		{
-			//Check if bounding boxes collide with each other
+			//Check if the top left corner of any own item lies inside any item of the ref bbox
 
-			if (!this->m_pvBBoxItems)
+			if ((this->IsEmpty()) || (roBBox.IsEmpty()))
 				return false;
-			
-			if (roBBox.IsEmpty())
+
+			//Own corners lie inside the own enclosing rectangle, so both enclosing rectangles must overlap
+			int iOffsetX = vMyAbsPos[0] - vRefAbsPos[0];
+			int iOffsetY = vMyAbsPos[1] - vRefAbsPos[1];
+
+			if ((this->m_vUnionMin[0] + iOffsetX > roBBox.m_vUnionMax[0]) || (this->m_vUnionMax[0] + iOffsetX < roBBox.m_vUnionMin[0]) || (this->m_vUnionMin[1] + iOffsetY > roBBox.m_vUnionMax[1]) || (this->m_vUnionMax[1] + iOffsetY < roBBox.m_vUnionMin[1]))
 				return false;
-			
-			for (size_t i = 0; i < this->m_pvBBoxItems->size(); i++) { //Iterate through own bbox list
-				//Check if current item collides ref bbox
-				if (roBBox.IsItemCollided(vRefAbsPos, vMyAbsPos, (*this->m_pvBBoxItems)[i]))
+
+			const int* piMinX = this->MinX();
+			const int* piMinY = this->MinY();
+
+			for (size_t i = 0; i < this->m_uiCount; i++) { //Iterate through own bbox list
+				if (roBBox.ContainsPoint(piMinX[i] + iOffsetX, piMinY[i] + iOffsetY))
 					return true;
 			}
 
 			return false;
 		}
 
-		bool IsInside(const Vector& vMyAbsPos, const Vector& vPosition)
+		bool IsInside(const Vector& vMyAbsPos, const Vector& vPosition) const
 		{
 			//Check if position is inside bbox
 
-			if (!this->m_pvBBoxItems)
+			if (this->IsEmpty())
+				return false;
+
+			return this->ContainsPoint(vPosition[0] - vMyAbsPos[0], vPosition[1] - vMyAbsPos[1]);
+		}
+
+		bool GetBounds(Vector& vMin, Vector& vMax) const
+		{
+			//Get the rectangle enclosing all bbox items (relative to the owner position)
+
+			if (this->IsEmpty())
 				return false;
 
+			vMin = this->m_vUnionMin;
+			vMax = this->m_vUnionMax;
+
+			return true;
+		}
+
+		bool LineIntersect(const Vector& vMyAbsPos, const Vector& vStart, const Vector& vEnd, float& flFraction) const
+		{
+			//Calculate the nearest fraction of the line from start to end lying inside any bbox item
+
 			if (this->IsEmpty())
 				return false;
 
-			for (size_t i = 0; i < this->m_pvBBoxItems->size(); i++) { //Loop through all bbox i tems
-				//Check if position is inside
-				if ((vPosition[0] >= vMyAbsPos[0] + (*this->m_pvBBoxItems)[i].pos[0]) && (vPosition[0] <= vMyAbsPos[0] + (*this->m_pvBBoxItems)[i].pos[0] + (*this->m_pvBBoxItems)[i].size[0]) && (vPosition[1] >= vMyAbsPos[1] + (*this->m_pvBBoxItems)[i].pos[1]) && (vPosition[1] <= vMyAbsPos[1] + (*this->m_pvBBoxItems)[i].pos[1] + (*this->m_pvBBoxItems)[i].size[1])) {
-					return true;
+			bool bHit = false;
+
+			for (size_t i = 0; i < this->m_uiCount; i++) { //Test against each item rectangle
+				Vector vMin(vMyAbsPos[0] + this->MinX()[i], vMyAbsPos[1] + this->MinY()[i]);
+				Vector vMax(vMyAbsPos[0] + this->MaxX()[i], vMyAbsPos[1] + this->MaxY()[i]);
+
+				float flItemFraction;
+				if ((ClipLine(vStart, vEnd, vMin, vMax, flItemFraction)) && ((!bHit) || (flItemFraction < flFraction))) {
+					flFraction = flItemFraction;
+					bHit = true;
 				}
 			}
 
-			return false;
+			return bHit;
+		}
+
+		static bool ClipLine(const Vector& vStart, const Vector& vEnd, const Vector& vMin, const Vector& vMax, float& flEnter)
+		{
+			//Clip the line from start to end against the rectangle (slab test) and get the fraction where it enters
+
+			float flLeave = 1.0f;
+			flEnter = 0.0f;
+
+			for (int i = 0; i < 2; i++) { //Intersect the parameter ranges of both axes
+				float flDir = (float)(vEnd[i] - vStart[i]);
+
+				if (flDir == 0.0f) {
+					//Parallel to this axis: must be within the slab
+					if ((vStart[i] < vMin[i]) || (vStart[i] > vMax[i]))
+						return false;
+
+					continue;
+				}
+
+				float flNear = (float)(vMin[i] - vStart[i]) / flDir;
+				float flFar = (float)(vMax[i] - vStart[i]) / flDir;
+				if (flNear > flFar) {
+					float flTemp = flNear;
+					flNear = flFar;
+					flFar = flTemp;
+				}
+
+				if (flNear > flEnter) flEnter = flNear;
+				if (flFar < flLeave) flLeave = flFar;
+
+				if (flEnter > flLeave)
+					return false;
+			}
+
+			return true;
 		}
 
-		inline bool IsEmpty(void) const { return (this->m_pvBBoxItems) ? (this->m_pvBBoxItems->size() == 0) : true; }
-		inline void Clear(void) { if (this->m_pvBBoxItems) this->m_pvBBoxItems->clear(); }
-		inline size_t Count(void) const { return this->m_pvBBoxItems->size(); }
-		inline const bbox_item_s& Item(const size_t uiItem) const { return (*this->m_pvBBoxItems)[uiItem]; }
+		inline bool IsEmpty(void) const { return this->m_uiCount == 0; }
+		inline void Clear(void) { this->m_uiCount = 0; }
+		inline size_t Count(void) const { return this->m_uiCount; }
+		inline bbox_item_s Item(const size_t uiItem) const
+		{
+			bbox_item_s sItem;
+			sItem.pos = Vector(this->MinX()[uiItem], this->MinY()[uiItem]);
+			sItem.size = Vector(this->MaxX()[uiItem] - this->MinX()[uiItem], this->MaxY()[uiItem] - this->MinY()[uiItem]);
+			return sItem;
+		}
 
-		void operator=(const CBoundingBox& ref)
+		CBoundingBox& operator=(const CBoundingBox& ref)
 		{
 			//Copy data from other bbox
 
-			this->m_pvBBoxItems->clear();
+			if (&ref == this)
+				return *this;
+
+			this->Clear();
 
 			for (size_t i = 0; i < ref.Count(); i++) {
-				this->m_pvBBoxItems->push_back(ref.Item(i));
+				bbox_item_s sItem = ref.Item(i);
+				this->AddBBoxItem(sItem.pos, sItem.size);
 			}
+
+			return *this;
 		}
 
 		//AngelScript interface methods
@@ -549,6 +683,199 @@ namespace Entity {
 		void Destruct(void* pMemory) { ((CTempSprite*)pMemory)->~CTempSprite(); }
 	};
 
+	/* Collision bitmask of a single sprite frame. Rows are stored as 64-bit words, bit x of a row is set for an opaque pixel */
+	class CCollisionMask {
+	private:
+		int m_iWidth;
+		int m_iHeight;
+		int m_iWordsPerRow;
+		Vector m_vOffset;
+		std::vector<unsigned long long> m_vRows;
+
+		inline const unsigned long long* Row(int y) const { return &this->m_vRows[(size_t)y * this->m_iWordsPerRow]; }
+
+		unsigned long long RowBits(int y, int x) const
+		{
+			//Get 64 bits of the row starting at column x. Columns outside of the mask are zero
+
+			const unsigned long long* pRow = this->Row(y);
+			int iWord = (x >= 0) ? x / 64 : -((63 - x) / 64);
+			int iShift = x - iWord * 64;
+
+			unsigned long long ullLow = ((iWord >= 0) && (iWord < this->m_iWordsPerRow)) ? pRow[iWord] : 0;
+			unsigned long long ullHigh = ((iWord + 1 >= 0) && (iWord + 1 < this->m_iWordsPerRow)) ? pRow[iWord + 1] : 0;
+
+			return (iShift) ? ((ullLow >> iShift) | (ullHigh << (64 - iShift))) : ullLow;
+		}
+	public:
+		CCollisionMask() : m_iWidth(0), m_iHeight(0), m_iWordsPerRow(0), m_vOffset(0, 0) {}
+		~CCollisionMask() {}
+
+		void Build(const D3DCOLOR* pPixels, int iPitch, int iWidth, int iHeight, byte ucAlphaThreshold, int iScale)
+		{
+			//Build mask from the given frame pixels. Scaling is done around the frame center, the same way sprites are drawn
+
+			this->m_iWidth = iWidth * iScale;
+			this->m_iHeight = iHeight * iScale;
+			this->m_iWordsPerRow = (this->m_iWidth + 63) / 64;
+			this->m_vOffset = Vector((iWidth / 2) * (1 - iScale), (iHeight / 2) * (1 - iScale));
+			this->m_vRows.assign((size_t)this->m_iWordsPerRow * this->m_iHeight, 0);
+
+			for (int y = 0; y < this->m_iHeight; y++) {
+				const D3DCOLOR* pRow = pPixels + (size_t)(y / iScale) * iPitch;
+				unsigned long long* pBits = &this->m_vRows[(size_t)y * this->m_iWordsPerRow];
+
+				for (int x = 0; x < this->m_iWidth; x++) {
+					if ((byte)(pRow[x / iScale] >> 24) >= ucAlphaThreshold)
+						pBits[x / 64] |= 1ULL << (x % 64);
+				}
+			}
+		}
+
+		bool Overlaps(const Vector& vMyAbsPos, const Vector& vRefAbsPos, const CCollisionMask& rRef) const
+		{
+			//Check if any opaque pixels of both masks overlap
+
+			int dx = (vRefAbsPos[0] + rRef.m_vOffset[0]) - (vMyAbsPos[0] + this->m_vOffset[0]);
+			int dy = (vRefAbsPos[1] + rRef.m_vOffset[1]) - (vMyAbsPos[1] + this->m_vOffset[1]);
+
+			//Calculate the overlapping area in own mask space
+			int x0 = (std::max)(0, dx), x1 = (std::min)(this->m_iWidth, dx + rRef.m_iWidth);
+			int y0 = (std::max)(0, dy), y1 = (std::min)(this->m_iHeight, dy + rRef.m_iHeight);
+			if ((x0 >= x1) || (y0 >= y1))
+				return false;
+
+			for (int y = y0; y < y1; y++) {
+				const unsigned long long* pRow = this->Row(y);
+
+				for (int w = x0 / 64; w <= (x1 - 1) / 64; w++) {
+					if (pRow[w] & rRef.RowBits(y - dy, w * 64 - dx))
+						return true;
+				}
+			}
+
+			return false;
+		}
+
+		bool OverlapsRect(const Vector& vMyAbsPos, const Vector& vMin, const Vector& vMax) const
+		{
+			//Check if any opaque pixel lies inside the given absolute rectangle, borders included
+
+			int x0 = (std::max)(0, vMin[0] - (vMyAbsPos[0] + this->m_vOffset[0])), x1 = (std::min)(this->m_iWidth, vMax[0] - (vMyAbsPos[0] + this->m_vOffset[0]) + 1);
+			int y0 = (std::max)(0, vMin[1] - (vMyAbsPos[1] + this->m_vOffset[1])), y1 = (std::min)(this->m_iHeight, vMax[1] - (vMyAbsPos[1] + this->m_vOffset[1]) + 1);
+			if ((x0 >= x1) || (y0 >= y1))
+				return false;
+
+			for (int w = x0 / 64; w <= (x1 - 1) / 64; w++) {
+				//Build the column range of the rectangle within this word
+				int iFrom = (std::max)(x0 - w * 64, 0);
+				int iTo = (std::min)(x1 - w * 64, 64);
+				unsigned long long ullColumns = ((iTo - iFrom == 64) ? ~0ULL : (((1ULL << (iTo - iFrom)) - 1) << iFrom));
+
+				for (int y = y0; y < y1; y++) {
+					if (this->Row(y)[w] & ullColumns)
+						return true;
+				}
+			}
+
+			return false;
+		}
+
+		bool IsInside(const Vector& vMyAbsPos, const Vector& vPosition) const
+		{
+			//Check if the position hits an opaque pixel
+
+			int x = vPosition[0] - (vMyAbsPos[0] + this->m_vOffset[0]);
+			int y = vPosition[1] - (vMyAbsPos[1] + this->m_vOffset[1]);
+			if ((x < 0) || (y < 0) || (x >= this->m_iWidth) || (y >= this->m_iHeight))
+				return false;
+
+			return (this->Row(y)[x / 64] & (1ULL << (x % 64))) != 0;
+		}
+	};
+
+	/* Collision masks of sprite frames. Built once per sprite file, frame layout, alpha threshold and scale */
+	class CCollisionMaskCache {
+	private:
+		struct mask_set_s {
+			std::wstring wszFile;
+			int iFrameCount;
+			int iFrameWidth;
+			int iFrameHeight;
+			byte ucAlphaThreshold;
+			int iScale;
+			std::vector<CCollisionMask> vFrames;
+		};
+
+		std::vector<mask_set_s*> m_vSets;
+	public:
+		CCollisionMaskCache() {}
+		~CCollisionMaskCache() { this->Clear(); }
+
+		const std::vector<CCollisionMask>* Get(const DxRenderer::HD3DSPRITE hSprite, byte ucAlphaThreshold, int iScale)
+		{
+			//Get the masks of all frames of the sprite, build them on first use
+
+			const DxRenderer::d3dsprite_s* pSprite = pGfxReference->GetSpriteData(hSprite);
+			if ((!pSprite) || (pSprite->iFrameWidth <= 0) || (pSprite->iFrameHeight <= 0) || (iScale < 1))
+				return nullptr;
+
+			int iFrameCount = (std::max)(pSprite->iFrameCount, 1);
+
+			//Search in list
+			for (size_t i = 0; i < this->m_vSets.size(); i++) {
+				const mask_set_s* pSet = this->m_vSets[i];
+				if ((pSet->wszFile == pSprite->wszFile) && (pSet->iFrameCount == iFrameCount) && (pSet->iFrameWidth == pSprite->iFrameWidth) && (pSet->iFrameHeight == pSprite->iFrameHeight) && (pSet->ucAlphaThreshold == ucAlphaThreshold) && (pSet->iScale == iScale))
+					return &pSet->vFrames;
+			}
+
+			std::vector<D3DCOLOR> vPixels;
+			int iWidth, iHeight;
+			if (!pGfxReference->ReadSpritePixels(hSprite, vPixels, iWidth, iHeight))
+				return nullptr;
+
+			mask_set_s* pSet = new mask_set_s;
+			if (!pSet)
+				return nullptr;
+
+			pSet->wszFile = pSprite->wszFile;
+			pSet->iFrameCount = iFrameCount;
+			pSet->iFrameWidth = pSprite->iFrameWidth;
+			pSet->iFrameHeight = pSprite->iFrameHeight;
+			pSet->ucAlphaThreshold = ucAlphaThreshold;
+			pSet->iScale = iScale;
+			pSet->vFrames.resize(iFrameCount);
+
+			//Build mask of each frame using the same frame layout as when drawing
+			for (int i = 0; i < iFrameCount; i++) {
+				int iFrameX = ((pSprite->iFramesPerLine > 0) ? i % pSprite->iFramesPerLine : 0) * pSprite->iFrameWidth;
+				int iFrameY = ((pSprite->iFramesPerLine > 0) ? i / pSprite->iFramesPerLine : 0) * pSprite->iFrameHeight;
+
+				if ((iFrameX + pSprite->iFrameWidth > iWidth) || (iFrameY + pSprite->iFrameHeight > iHeight))
+					continue;
+
+				pSet->vFrames[i].Build(&vPixels[(size_t)iFrameY * iWidth + iFrameX], iWidth, pSprite->iFrameWidth, pSprite->iFrameHeight, ucAlphaThreshold, iScale);
+			}
+
+			this->m_vSets.push_back(pSet);
+
+			return &pSet->vFrames;
+		}
+
+		void Clear(void)
+		{
+			//Free all masks
+
+			for (size_t i = 0; i < this->m_vSets.size(); i++) {
+				delete this->m_vSets[i];
+			}
+
+			this->m_vSets.clear();
+		}
+	};
+
+	extern CCollisionMaskCache oCollisionMaskCache;
+
 	/* Model component */
 	class CModel {
 	private:
@@ -556,8 +883,12 @@ namespace Entity {
 		DxRenderer::HD3DSPRITE m_hSprite;
 		CBoundingBox m_oBBox;
 		Vector m_vCenter;
+		const std::vector<CCollisionMask>* m_pvMasks;
+		int m_iFrame;
+
+		inline const CCollisionMask* Mask(void) const { return ((this->m_pvMasks) && (this->m_iFrame >= 0) && ((size_t)this->m_iFrame < this->m_pvMasks->size())) ? &(*this->m_pvMasks)[this->m_iFrame] : nullptr; }
 	public:
-		CModel() {}
+		CModel() : m_pvMasks(nullptr), m_iFrame(0) {}
 		//CModel(const std::string& szInputFile) { this->Initialize(szInputFile); }
 		//CModel(const std::string& szInputFile, bool bForceCustomSize) { this->Initialize(szInputFile, bForceCustomSize); }
 		~CModel() { this->Release(); }
@@ -643,29 +974,72 @@ namespace Entity {
 				return;
 
 			//Free sprite
-			pGfxReference->FreeSprite(this->m_hSprite);
+			if (pGfxReference)
+				pGfxReference->FreeSprite(this->m_hSprite);
 
 			//Clear bbox data
 			this->m_oBBox.Clear();
 
+			//Masks stay cached for other models using the same sprite
+			this->m_pvMasks = nullptr;
+
 			//Clear indicator
 			this->m_bReady = false;
 		}
 
 		bool IsCollided(const Vector& vMyAbsPos, const Vector& vRefAbsPos, const CModel& rRefMdl)
 		{
-			//Check for collision
+			//Check for collision. If pixel collision is enabled, the bbox hit is refined by the masks
 
-			return this->m_oBBox.IsCollided(vMyAbsPos, vRefAbsPos, rRefMdl.BBox());
+			if (!this->m_oBBox.IsCollided(vMyAbsPos, vRefAbsPos, rRefMdl.BBox()))
+				return false;
+
+			const CCollisionMask* pMask = this->Mask();
+			const CCollisionMask* pRefMask = rRefMdl.Mask();
+
+			if ((pMask) && (pRefMask))
+				return pMask->Overlaps(vMyAbsPos, vRefAbsPos, *pRefMask);
+
+			//Only one side has a mask: test it against the bbox of the other side
+			Vector vMin, vMax;
+			if (pMask) {
+				rRefMdl.BBox().GetBounds(vMin, vMax);
+				return pMask->OverlapsRect(vMyAbsPos, Vector(vRefAbsPos[0] + vMin[0], vRefAbsPos[1] + vMin[1]), Vector(vRefAbsPos[0] + vMax[0], vRefAbsPos[1] + vMax[1]));
+			} else if (pRefMask) {
+				this->m_oBBox.GetBounds(vMin, vMax);
+				return pRefMask->OverlapsRect(vRefAbsPos, Vector(vMyAbsPos[0] + vMin[0], vMyAbsPos[1] + vMin[1]), Vector(vMyAbsPos[0] + vMax[0], vMyAbsPos[1] + vMax[1]));
+			}
+
+			return true;
 		}
 
 		bool IsInside(const Vector& vMyAbsPos, const Vector& vPosition)
 		{
 			//Check if inside
 
-			return this->m_oBBox.IsInside(vMyAbsPos, vPosition);
+			if (!this->m_oBBox.IsInside(vMyAbsPos, vPosition))
+				return false;
+
+			const CCollisionMask* pMask = this->Mask();
+
+			return (pMask) ? pMask->IsInside(vMyAbsPos, vPosition) : true;
+		}
+
+		bool EnablePixelCollision(byte ucAlphaThreshold, int iScale)
+		{
+			//Use collision masks built from the sprite alpha channel in addition to the bbox
+
+			if (!this->m_bReady)
+				return false;
+
+			this->m_pvMasks = oCollisionMaskCache.Get(this->m_hSprite, ucAlphaThreshold, iScale);
+
+			return this->m_pvMasks != nullptr;
 		}
 
+		inline void DisablePixelCollision(void) { this->m_pvMasks = nullptr; }
+		inline void SetFrame(int iFrame) { this->m_iFrame = iFrame; }
+
 		inline bool Alloc(void) { return this->m_oBBox.Alloc(); }
 		inline void SetCenter(const Vector& vCenter) { this->m_vCenter = vCenter; }
 
@@ -674,6 +1048,8 @@ namespace Entity {
 		inline const CBoundingBox& BBox(void) const { return this->m_oBBox; }
 		inline const DxRenderer::HD3DSPRITE Sprite(void) const { return this->m_hSprite; }
 		inline const Vector& Center(void) const { return this->m_vCenter; }
+		inline bool HasPixelCollision(void) const { return this->m_pvMasks != nullptr; }
+		inline int Frame(void) const { return this->m_iFrame; }
 
 		//Assign operator
 		void operator=(const CModel& ref)
@@ -681,6 +1057,8 @@ namespace Entity {
 			this->m_hSprite = ref.Sprite();
 			this->m_oBBox = ref.BBox();
 			this->m_vCenter = ref.Center();
+			this->m_pvMasks = ref.m_pvMasks;
+			this->m_iFrame = ref.Frame();
 		}
 
 		//AngelScript interface methods
@@ -690,148 +1068,548 @@ namespace Entity {
 		void Destruct(void* pMemory) { ((CModel*)pMemory)->~CModel(); }
 	};
 
-	/* Managed entity component */
-	class CScriptedEntity {
-	public:
-		typedef byte DamageValue;
+	/* Spatial hash grid component (broad phase) */
+	#define ENT_SPATIAL_CELL_SIZE 128
+	#define ENT_SPATIAL_BUCKET_COUNT 4096
+	#define ENT_SPATIAL_MAX_CELL_SPAN 64
+	class CSpatialGrid {
 	private:
-		std::string m_szClassName;
-		Scripting::HSISCRIPT m_hScript;
-		asIScriptObject* m_pScriptObject;
-
-		void Release(void)
-		{
-			//Release resources
+		struct grid_entry_s {
+			int iCellX, iCellY;
+			size_t uiObject;
+			size_t uiNext;
+		};
 
-			this->m_pScriptObject->Release();
-			this->m_pScriptObject = nullptr;
-		}
-	public:
-		CScriptedEntity(const Scripting::HSISCRIPT hScript, asIScriptObject* pObject) : m_pScriptObject(pObject), m_hScript(hScript) {}
-		CScriptedEntity(const Scripting::HSISCRIPT hScript, const std::string& szClassName) : m_szClassName(szClassName) { this->Initialize(hScript, szClassName); }
-		~CScriptedEntity() { this->Release(); }
+		int m_iCellSize;
+		std::vector<size_t> m_vBuckets;
+		std::vector<grid_entry_s> m_vEntries;
+		std::vector<size_t> m_vOversized; //Objects spanning too many cells, these are checked by every query
+		std::vector<unsigned int> m_vQueryMarks;
+		unsigned int m_uiQueryMark;
 
-		bool Initialize(const Scripting::HSISCRIPT hScript, const std::string& szClassName)
+		inline int CellCoord(int iValue) const
 		{
-			//Initialize scripted entity
-
-			if (!szClassName.length())
-				return false;
-
-			//Allocate class instance
-			this->m_pScriptObject = pScrReference->AllocClass(hScript, szClassName);
+			//Get cell coordinate of a screen coordinate (floored for negative values)
 
-			//Store data
-			this->m_hScript = hScript;
-
-			return this->m_pScriptObject != nullptr;
+			return (iValue >= 0) ? iValue / this->m_iCellSize : -((-iValue + this->m_iCellSize - 1) / this->m_iCellSize);
 		}
 
-		void OnSpawn(const Vector& vAtPos)
+		inline size_t Bucket(int iCellX, int iCellY) const
 		{
-			//Inform class instance of event
-
-			Vector v(vAtPos);
+			//Hash cell coordinates to bucket index
 
-			BEGIN_PARAMS(vArgs);
-			PUSH_OBJECT(&v);
-
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "void OnSpawn(const Vector& in)", &vArgs, nullptr);
-
-			END_PARAMS(vArgs);
+			return (size_t)(((unsigned int)iCellX * 73856093u) ^ ((unsigned int)iCellY * 19349663u)) & (this->m_vBuckets.size() - 1);
 		}
 
-		void OnRelease(void)
+		void CellRange(const Vector& vMin, const Vector& vMax, int& iMinX, int& iMinY, int& iMaxX, int& iMaxY) const
 		{
-			//Inform class instance of event
+			//Calculate the range of cells covered by a rectangle
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "void OnRelease()", nullptr, nullptr);
+			iMinX = this->CellCoord(vMin[0]);
+			iMinY = this->CellCoord(vMin[1]);
+			iMaxX = this->CellCoord(vMax[0]);
+			iMaxY = this->CellCoord(vMax[1]);
 		}
 
-		void OnProcess(void)
+		inline bool IsOversized(int iMinX, int iMinY, int iMaxX, int iMaxY) const
 		{
-			//Inform class instance of event
+			//Check if a cell range is too large to be walked cell by cell
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "void OnProcess()", nullptr, nullptr);
+			return (iMaxX - iMinX >= ENT_SPATIAL_MAX_CELL_SPAN) || (iMaxY - iMinY >= ENT_SPATIAL_MAX_CELL_SPAN);
 		}
 
-		void OnDraw(void)
+		inline void Report(size_t uiObject, std::vector<size_t>& vOut)
 		{
-			//Inform class instance of event
+			//Add object to the query result unless already reported
+
+			if (this->m_vQueryMarks[uiObject] == this->m_uiQueryMark)
+				return;
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "void OnDraw()", nullptr, nullptr);
+			this->m_vQueryMarks[uiObject] = this->m_uiQueryMark;
+			vOut.push_back(uiObject);
 		}
 
-		void OnDrawOnTop(void)
+		void NextQueryMark(void)
 		{
-			//Inform class instance of event
+			//Advance query mark, reset all marks on wrap-around
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "void OnDrawOnTop()", nullptr, nullptr);
+			if (++this->m_uiQueryMark == 0) {
+				std::fill(this->m_vQueryMarks.begin(), this->m_vQueryMarks.end(), 0);
+				this->m_uiQueryMark = 1;
+			}
 		}
 
-		bool DoUserCleaning(void)
+		void InitLineAxis(int iStart, int iEnd, int iCell, int& iStep, float& flNext, float& flDelta) const
 		{
-			//Query whether entity shall be cleaned by user
+			//Setup stepping of one axis for walking the cells along a line
 
-			bool bResult;
+			if (iEnd == iStart) {
+				//Never crosses a cell border on this axis
+				iStep = 0;
+				flNext = flDelta = 2.0f;
+				return;
+			}
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "bool DoUserCleaning()", nullptr, &bResult, Scripting::FA_BYTE);
+			float flDir = (float)(iEnd - iStart);
+			iStep = (iEnd > iStart) ? 1 : -1;
 
-			return bResult;
+			int iBorder = (iStep > 0) ? (iCell + 1) * this->m_iCellSize : iCell * this->m_iCellSize;
+			flNext = (float)(iBorder - iStart) / flDir;
+			flDelta = (float)this->m_iCellSize / ((flDir > 0.0f) ? flDir : -flDir);
 		}
+	public:
+		CSpatialGrid() : m_iCellSize(ENT_SPATIAL_CELL_SIZE), m_uiQueryMark(0) { this->m_vBuckets.resize(ENT_SPATIAL_BUCKET_COUNT, SI_INVALID_ID); }
+		~CSpatialGrid() {}
 
-		byte IsDamageable(void)
+		void Clear(size_t uiObjectCount)
 		{
-			//Query if entity is damageable (0 = non-damageable, 1 = damage all, 2 = damage only entities with different name)
+			//Clear grid data and prepare for the given amount of objects
 
-			byte ucResult;
-
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "DamageType IsDamageable()", nullptr, &ucResult, Scripting::FA_BYTE);
+			std::fill(this->m_vBuckets.begin(), this->m_vBuckets.end(), SI_INVALID_ID);
+			this->m_vEntries.clear();
+			this->m_vOversized.clear();
 
-			return ucResult;
+			if (this->m_vQueryMarks.size() < uiObjectCount) {
+				this->m_vQueryMarks.resize(uiObjectCount, 0);
+			}
 		}
 
-		void OnDamage(DamageValue dv)
+		void Insert(size_t uiObject, const Vector& vMin, const Vector& vMax)
 		{
-			//Inform of being damaged
-
-			BEGIN_PARAMS(vArgs);
-			PUSH_BYTE(dv);
+			//Insert object into all cells covered by its rectangle
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "void OnDamage(DamageValue dv)", &vArgs, nullptr);
+			int iMinX, iMinY, iMaxX, iMaxY;
+			this->CellRange(vMin, vMax, iMinX, iMinY, iMaxX, iMaxY);
 
-			END_PARAMS(vArgs);
-		}
+			if (uiObject >= this->m_vQueryMarks.size()) {
+				this->m_vQueryMarks.resize(uiObject + 1, 0);
+			}
 
-		CModel* GetModel(void)
-		{
-			//Query model object pointer
+			//Keep objects covering too many cells in a list that is checked by every query
+			if (this->IsOversized(iMinX, iMinY, iMaxX, iMaxY)) {
+				this->m_vOversized.push_back(uiObject);
+				return;
+			}
 
-			CModel* pResult;
+			for (int y = iMinY; y <= iMaxY; y++) {
+				for (int x = iMinX; x <= iMaxX; x++) {
+					size_t uiBucket = this->Bucket(x, y);
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "Model& GetModel()", nullptr, &pResult, Scripting::FA_OBJECT);
+					//Setup data and link as head of the bucket chain
+					grid_entry_s sEntry;
+					sEntry.iCellX = x;
+					sEntry.iCellY = y;
+					sEntry.uiObject = uiObject;
+					sEntry.uiNext = this->m_vBuckets[uiBucket];
 
-			return pResult;
+					this->m_vBuckets[uiBucket] = this->m_vEntries.size();
+					this->m_vEntries.push_back(sEntry);
+				}
+			}
 		}
 
-		Vector GetPosition(void)
+		void Query(const Vector& vMin, const Vector& vMax, std::vector<size_t>& vOut)
 		{
-			//Query position
+			//Collect all objects sharing at least one cell with the given rectangle. Each object is reported once
 
-			Vector* pResult;
+			vOut.clear();
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "Vector& GetPosition()", nullptr, &pResult, Scripting::FA_OBJECT);
+			int iMinX, iMinY, iMaxX, iMaxY;
+			this->CellRange(vMin, vMax, iMinX, iMinY, iMaxX, iMaxY);
 
-			return *pResult;
-		}
+			this->NextQueryMark();
 
-		float GetRotation(void)
-		{
-			//Query rotation
+			for (size_t i = 0; i < this->m_vOversized.size(); i++) {
+				this->Report(this->m_vOversized[i], vOut);
+			}
+
+			//Scan all entries if the rectangle covers more cells than can be walked
+			if (this->IsOversized(iMinX, iMinY, iMaxX, iMaxY)) {
+				for (size_t i = 0; i < this->m_vEntries.size(); i++) {
+					const grid_entry_s& rEntry = this->m_vEntries[i];
+
+					if ((rEntry.iCellX >= iMinX) && (rEntry.iCellX <= iMaxX) && (rEntry.iCellY >= iMinY) && (rEntry.iCellY <= iMaxY))
+						this->Report(rEntry.uiObject, vOut);
+				}
+
+				return;
+			}
+
+			for (int y = iMinY; y <= iMaxY; y++) {
+				for (int x = iMinX; x <= iMaxX; x++) {
+					for (size_t uiEntry = this->m_vBuckets[this->Bucket(x, y)]; uiEntry != SI_INVALID_ID; uiEntry = this->m_vEntries[uiEntry].uiNext) { //Walk bucket chain
+						const grid_entry_s& rEntry = this->m_vEntries[uiEntry];
+
+						//Skip entries of different cells sharing this bucket
+						if ((rEntry.iCellX != x) || (rEntry.iCellY != y))
+							continue;
+
+						this->Report(rEntry.uiObject, vOut);
+					}
+				}
+			}
+		}
+
+		template <typename TLineTest>
+		bool TraceLine(const Vector& vStart, const Vector& vEnd, TLineTest& rLineTest, size_t& uiHitObject, float& flHitFraction)
+		{
+			//Walk the cells along the line from start to end (DDA) and find the object hit nearest to the start.
+			//The line test is called once per object as bool(size_t uiObject, float& flFraction)
+
+			int iCellX = this->CellCoord(vStart[0]);
+			int iCellY = this->CellCoord(vStart[1]);
+			int iEndCellX = this->CellCoord(vEnd[0]);
+			int iEndCellY = this->CellCoord(vEnd[1]);
+
+			int iStepX, iStepY;
+			float flNextX, flNextY, flDeltaX, flDeltaY;
+			this->InitLineAxis(vStart[0], vEnd[0], iCellX, iStepX, flNextX, flDeltaX);
+			this->InitLineAxis(vStart[1], vEnd[1], iCellY, iStepY, flNextY, flDeltaY);
+
+			size_t uiCellCount = (size_t)((iEndCellX > iCellX) ? iEndCellX - iCellX : iCellX - iEndCellX) + (size_t)((iEndCellY > iCellY) ? iEndCellY - iCellY : iCellY - iEndCellY) + 1;
+			bool bHit = false;
+
+			this->NextQueryMark();
+
+			//Objects not stored in cells are tested first
+			for (size_t i = 0; i < this->m_vOversized.size(); i++) {
+				size_t uiObject = this->m_vOversized[i];
+				this->m_vQueryMarks[uiObject] = this->m_uiQueryMark;
+
+				float flFraction;
+				if ((rLineTest(uiObject, flFraction)) && ((!bHit) || (flFraction < flHitFraction))) {
+					uiHitObject = uiObject;
+					flHitFraction = flFraction;
+					bHit = true;
+				}
+			}
+
+			for (size_t uiCell = 0; uiCell < uiCellCount; uiCell++) {
+				for (size_t uiEntry = this->m_vBuckets[this->Bucket(iCellX, iCellY)]; uiEntry != SI_INVALID_ID; uiEntry = this->m_vEntries[uiEntry].uiNext) { //Walk bucket chain
+					const grid_entry_s& rEntry = this->m_vEntries[uiEntry];
+
+					//Skip entries of different cells sharing this bucket and objects already tested
+					if ((rEntry.iCellX != iCellX) || (rEntry.iCellY != iCellY) || (this->m_vQueryMarks[rEntry.uiObject] == this->m_uiQueryMark))
+						continue;
+
+					this->m_vQueryMarks[rEntry.uiObject] = this->m_uiQueryMark;
+
+					float flFraction;
+					if ((rLineTest(rEntry.uiObject, flFraction)) && ((!bHit) || (flFraction < flHitFraction))) {
+						uiHitObject = rEntry.uiObject;
+						flHitFraction = flFraction;
+						bHit = true;
+					}
+				}
+
+				//Nothing in the following cells can be nearer than a hit located before the exit of this cell
+				float flCellExit = (flNextX < flNextY) ? flNextX : flNextY;
+				if (((bHit) && (flHitFraction <= flCellExit)) || (flCellExit > 1.0f))
+					break;
+
+				//Step into the next cell
+				if (flNextX < flNextY) {
+					iCellX += iStepX;
+					flNextX += flDeltaX;
+				} else {
+					iCellY += iStepY;
+					flNextY += flDeltaY;
+				}
+			}
+
+			return bHit;
+		}
+
+		//Setters
+		inline void SetCellSize(int iCellSize) { if (iCellSize > 0) this->m_iCellSize = iCellSize; }
+
+		//Getters
+		inline int CellSize(void) const { return this->m_iCellSize; }
+		inline size_t EntryCount(void) const { return this->m_vEntries.size(); }
+		inline size_t OversizedCount(void) const { return this->m_vOversized.size(); }
+	};
+
+	/* Fixed-block object pool component */
+	struct pool_stats_s {
+		size_t uiLive;
+		size_t uiPeak;
+		size_t uiCapacity;
+		size_t uiAllocations;
+		size_t uiHeapAllocations;
+	};
+
+	template <typename TObject, size_t uiBlockSize>
+	class CObjectPool {
+	private:
+		typedef typename std::aligned_storage<sizeof(TObject), alignof(TObject)>::type object_storage_t;
+
+		std::vector<object_storage_t*> m_vBlocks;
+		std::vector<object_storage_t*> m_vFree;
+		pool_stats_s m_sStats;
+
+		bool AllocBlock(void)
+		{
+			//Allocate a new block of records and add them to the free list
+
+			object_storage_t* pBlock = new object_storage_t[uiBlockSize];
+			if (!pBlock)
+				return false;
+
+			this->m_vBlocks.push_back(pBlock);
+			this->m_vFree.reserve(this->m_vBlocks.size() * uiBlockSize);
+
+			//Add in reverse order so that records are handed out in memory order
+			for (size_t i = uiBlockSize; i > 0; i--) {
+				this->m_vFree.push_back(&pBlock[i - 1]);
+			}
+
+			this->m_sStats.uiCapacity += uiBlockSize;
+			this->m_sStats.uiHeapAllocations++;
+
+			return true;
+		}
+
+		void Release(void)
+		{
+			//Release resources. All objects must have been deleted before
+
+			for (size_t i = 0; i < this->m_vBlocks.size(); i++) {
+				delete[] this->m_vBlocks[i];
+			}
+
+			this->m_vBlocks.clear();
+			this->m_vFree.clear();
+		}
+	public:
+		CObjectPool() { memset(&this->m_sStats, 0x00, sizeof(this->m_sStats)); }
+		~CObjectPool() { this->Release(); }
+
+		void Reserve(size_t uiObjectCount)
+		{
+			//Allocate blocks until the given amount of objects fits
+
+			while (this->m_sStats.uiCapacity < uiObjectCount) {
+				if (!this->AllocBlock())
+					break;
+			}
+		}
+
+		template <typename... TArgs>
+		TObject* New(TArgs&&... args)
+		{
+			//Construct an object in a free record. Only allocates from the heap if the pool is exhausted
+
+			if ((!this->m_vFree.size()) && (!this->AllocBlock()))
+				return nullptr;
+
+			object_storage_t* pRecord = this->m_vFree.back();
+			this->m_vFree.pop_back();
+
+			this->m_sStats.uiAllocations++;
+			if (++this->m_sStats.uiLive > this->m_sStats.uiPeak)
+				this->m_sStats.uiPeak = this->m_sStats.uiLive;
+
+			return new (pRecord) TObject(std::forward<TArgs>(args)...);
+		}
+
+		void Delete(TObject* pObject)
+		{
+			//Destruct an object and recycle its record
+
+			if (!pObject)
+				return;
+
+			pObject->~TObject();
+
+			this->m_vFree.push_back(reinterpret_cast<object_storage_t*>(pObject));
+			this->m_sStats.uiLive--;
+		}
+
+		//Getters
+		inline const pool_stats_s& Stats(void) const { return this->m_sStats; }
+	};
+
+	/* Generational entity handle: slot index in the low, generation in the high 32 bits */
+	typedef unsigned long long EntityHandle;
+	#define ENT_INVALID_HANDLE 0
+
+	/* Methods of IScriptedEntity, resolved once per script class */
+	enum EntityMethod { EM_ONSPAWN, EM_ONRELEASE, EM_ONPROCESS, EM_ONDRAW, EM_ONDRAWONTOP, EM_DOUSERCLEANING, EM_ISDAMAGEABLE, EM_ONDAMAGE, EM_ONCONTACT, EM_GETMODEL, EM_GETPOSITION, EM_GETROTATION, EM_ISMOVABLE, EM_GETSELECTIONSIZE, EM_GETDAMAGEVALUE, EM_NEEDSREMOVAL, EM_GETNAME, EM_MOVETO, EM_COUNT };
+	extern const char* const aszEntityMethods[EM_COUNT];
+	extern Scripting::si_method_table_s oNoEntityMethods; //Used by entities without script object
+
+	/* Managed entity component */
+	class CScriptedEntity {
+	public:
+		typedef byte DamageValue;
+	private:
+		std::string m_szClassName;
+		Scripting::HSISCRIPT m_hScript;
+		asIScriptObject* m_pScriptObject;
+		EntityHandle m_hHandle;
+		const Scripting::si_method_table_s* m_pMethods;
+		bool m_bHandlesContacts;
+		unsigned int m_uiCategory;
+		unsigned int m_uiMask;
+		size_t m_uiNameId;
+		size_t m_uiNameSlot;
+		bool m_bMovable;
+		Vector m_vSelectionSize;
+		bool m_bHasExtent;
+		Vector m_vExtentMin;
+		Vector m_vExtentMax;
+		ULONGLONG m_ullNextThink;
+		bool m_bSleeping;
+		bool m_bLodEnabled;
+		DWORD m_dwLodRemoveDelay;
+		unsigned int m_uiLodProcessInterval;
+		bool m_bOffscreen;
+		ULONGLONG m_ullFarSince;
+
+		void Release(void)
+		{
+			//Release resources
+
+			this->m_pScriptObject->Release();
+			this->m_pScriptObject = nullptr;
+		}
+
+		void QueryOptionalMethods(void)
+		{
+			//Resolve the methods of the script class and check which optional methods are implemented
+
+			this->m_pMethods = (this->m_pScriptObject) ? pScrReference->GetMethodTable(this->m_pScriptObject->GetObjectType(), aszEntityMethods, EM_COUNT) : &oNoEntityMethods;
+			if (!this->m_pMethods)
+				this->m_pMethods = &oNoEntityMethods;
+
+			this->m_bHandlesContacts = this->m_pMethods->vMethods[EM_ONCONTACT] != nullptr;
+		}
+	public:
+		CScriptedEntity(const Scripting::HSISCRIPT hScript, asIScriptObject* pObject) : m_pScriptObject(pObject), m_hScript(hScript), m_hHandle(ENT_INVALID_HANDLE), m_uiCategory(ENT_LAYER_DEFAULT), m_uiMask(ENT_LAYER_ALL), m_uiNameId(0), m_uiNameSlot(0), m_bMovable(false), m_vSelectionSize(0, 0), m_bHasExtent(false), m_vExtentMin(0, 0), m_vExtentMax(0, 0), m_ullNextThink(0), m_bSleeping(false), m_bLodEnabled(false), m_dwLodRemoveDelay(0), m_uiLodProcessInterval(1), m_bOffscreen(false), m_ullFarSince(0) { this->QueryOptionalMethods(); }
+		CScriptedEntity(const Scripting::HSISCRIPT hScript, const std::string& szClassName) : m_szClassName(szClassName), m_hHandle(ENT_INVALID_HANDLE), m_uiCategory(ENT_LAYER_DEFAULT), m_uiMask(ENT_LAYER_ALL), m_uiNameId(0), m_uiNameSlot(0), m_bMovable(false), m_vSelectionSize(0, 0), m_bHasExtent(false), m_vExtentMin(0, 0), m_vExtentMax(0, 0), m_ullNextThink(0), m_bSleeping(false), m_bLodEnabled(false), m_dwLodRemoveDelay(0), m_uiLodProcessInterval(1), m_bOffscreen(false), m_ullFarSince(0) { this->Initialize(hScript, szClassName); this->QueryOptionalMethods(); }
+		~CScriptedEntity() { this->Release(); }
+
+		bool Initialize(const Scripting::HSISCRIPT hScript, const std::string& szClassName)
+		{
+			//Initialize scripted entity
+
+			if (!szClassName.length())
+				return false;
+
+			//Allocate class instance
+			this->m_pScriptObject = pScrReference->AllocClass(hScript, szClassName);
+
+			//Store data
+			this->m_hScript = hScript;
+
+			return this->m_pScriptObject != nullptr;
+		}
+
+		void OnSpawn(const Vector& vAtPos)
+		{
+			//Inform class instance of event
+
+			Vector v(vAtPos);
+
+			pScrReference->Call<void>(this->m_pMethods->vMethods[EM_ONSPAWN], this->m_pScriptObject, nullptr, &v);
+		}
+
+		void OnRelease(void)
+		{
+			//Inform class instance of event
+
+			pScrReference->Call<void>(this->m_pMethods->vMethods[EM_ONRELEASE], this->m_pScriptObject, nullptr);
+		}
+
+		void OnProcess(void)
+		{
+			//Inform class instance of event
+
+			pScrReference->Call<void>(this->m_pMethods->vMethods[EM_ONPROCESS], this->m_pScriptObject, nullptr);
+		}
+
+		void OnDraw(void)
+		{
+			//Inform class instance of event
+
+			pScrReference->Call<void>(this->m_pMethods->vMethods[EM_ONDRAW], this->m_pScriptObject, nullptr);
+		}
+
+		void OnDrawOnTop(void)
+		{
+			//Inform class instance of event
+
+			pScrReference->Call<void>(this->m_pMethods->vMethods[EM_ONDRAWONTOP], this->m_pScriptObject, nullptr);
+		}
+
+		bool DoUserCleaning(void)
+		{
+			//Query whether entity shall be cleaned by user
+
+			bool bResult;
+
+			pScrReference->Call<bool>(this->m_pMethods->vMethods[EM_DOUSERCLEANING], this->m_pScriptObject, &bResult);
+
+			return bResult;
+		}
+
+		byte IsDamageable(void)
+		{
+			//Query if entity is damageable (0 = non-damageable, 1 = damage all, 2 = damage only entities with different name)
+
+			byte ucResult;
+
+			pScrReference->Call<byte>(this->m_pMethods->vMethods[EM_ISDAMAGEABLE], this->m_pScriptObject, &ucResult);
+
+			return ucResult;
+		}
+
+		void OnDamage(DamageValue dv)
+		{
+			//Inform of being damaged
+
+			pScrReference->Call<void>(this->m_pMethods->vMethods[EM_ONDAMAGE], this->m_pScriptObject, nullptr, dv);
+		}
+
+		void OnContact(asIScriptObject* pOther, ContactPhase ePhase)
+		{
+			//Inform of contact with another entity if the optional handler is implemented
+
+			if (!this->m_bHandlesContacts)
+				return;
+
+			pScrReference->Call<void>(this->m_pMethods->vMethods[EM_ONCONTACT], this->m_pScriptObject, nullptr, pOther, ePhase);
+		}
+
+		CModel* GetModel(void)
+		{
+			//Query model object pointer
+
+			CModel* pResult;
+
+			pScrReference->Call<CModel*>(this->m_pMethods->vMethods[EM_GETMODEL], this->m_pScriptObject, &pResult);
+
+			return pResult;
+		}
+
+		Vector GetPosition(void)
+		{
+			//Query position
+
+			Vector* pResult;
+
+			pScrReference->Call<Vector*>(this->m_pMethods->vMethods[EM_GETPOSITION], this->m_pScriptObject, &pResult);
+
+			return *pResult;
+		}
+
+		float GetRotation(void)
+		{
+			//Query rotation
 
 			float flResult;
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "float GetRotation()", nullptr, &flResult, Scripting::FA_FLOAT);
+			pScrReference->Call<float>(this->m_pMethods->vMethods[EM_GETROTATION], this->m_pScriptObject, &flResult);
 
 			return flResult;
 		}
@@ -842,7 +1620,7 @@ namespace Entity {
 
 			bool bResult;
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "bool IsMovable()", nullptr, &bResult, Scripting::FA_BYTE);
+			pScrReference->Call<bool>(this->m_pMethods->vMethods[EM_ISMOVABLE], this->m_pScriptObject, &bResult);
 
 			return bResult;
 		}
@@ -853,18 +1631,32 @@ namespace Entity {
 
 			Vector* pResult;
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "Vector& GetSelectionSize()", nullptr, &pResult, Scripting::FA_OBJECT);
+			pScrReference->Call<Vector*>(this->m_pMethods->vMethods[EM_GETSELECTIONSIZE], this->m_pScriptObject, &pResult);
 
 			return *pResult;
 		}
 
+		void CacheExtent(void)
+		{
+			//Query the extent around the position once. The model bounds are used if set, else the selection size of movable entities
+
+			CModel* pModel = this->GetModel();
+			this->m_bHasExtent = (pModel) && (pModel->BBox().GetBounds(this->m_vExtentMin, this->m_vExtentMax));
+
+			if ((!this->m_bHasExtent) && (this->m_bMovable) && ((this->m_vSelectionSize[0] > 0) || (this->m_vSelectionSize[1] > 0))) {
+				this->m_vExtentMin = Vector(0, 0);
+				this->m_vExtentMax = this->m_vSelectionSize;
+				this->m_bHasExtent = true;
+			}
+		}
+
 		DamageValue GetDamageValue(void)
 		{
 			//Get damage value
 
 			DamageValue dvResult;
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "DamageValue GetDamageValue()", nullptr, &dvResult, Scripting::FA_BYTE);
+			pScrReference->Call<DamageValue>(this->m_pMethods->vMethods[EM_GETDAMAGEVALUE], this->m_pScriptObject, &dvResult);
 
 			return dvResult;
 		}
@@ -875,7 +1667,7 @@ namespace Entity {
 
 			bool bResult;
 
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "bool NeedsRemoval()", nullptr, &bResult, Scripting::FA_BYTE);
+			pScrReference->Call<bool>(this->m_pMethods->vMethods[EM_NEEDSREMOVAL], this->m_pScriptObject, &bResult);
 
 			return bResult;
 		}
@@ -886,7 +1678,7 @@ namespace Entity {
 
 			std::string szResult;
 			
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "string GetName()", nullptr, &szResult, Scripting::FA_STRING);
+			pScrReference->Call<std::string>(this->m_pMethods->vMethods[EM_GETNAME], this->m_pScriptObject, &szResult);
 
 			return szResult;
 		}
@@ -897,37 +1689,872 @@ namespace Entity {
 
 			Vector v(vToPos);
 
-			BEGIN_PARAMS(vArgs);
-			PUSH_OBJECT(&v);
-
-			pScrReference->CallScriptMethod(this->m_hScript, this->m_pScriptObject, "void MoveTo(const Vector& in vec)", &vArgs, nullptr);
-
-			END_PARAMS(vArgs);
+			pScrReference->Call<void>(this->m_pMethods->vMethods[EM_MOVETO], this->m_pScriptObject, nullptr, &v);
 		}
 
 		//Getters
 		inline bool IsReady(void) const { return (this->m_pScriptObject != nullptr); }
 		inline asIScriptObject* Object(void) const { return this->m_pScriptObject; }
+		inline EntityHandle Handle(void) const { return this->m_hHandle; }
+		inline bool HandlesContacts(void) const { return this->m_bHandlesContacts; }
+		inline unsigned int CollisionCategory(void) const { return this->m_uiCategory; }
+		inline unsigned int CollisionMask(void) const { return this->m_uiMask; }
+		inline size_t NameId(void) const { return this->m_uiNameId; }
+		inline size_t NameSlot(void) const { return this->m_uiNameSlot; }
+		inline bool Movable(void) const { return this->m_bMovable; }
+		inline const Vector& SelectionSize(void) const { return this->m_vSelectionSize; }
+		inline bool HasExtent(void) const { return this->m_bHasExtent; }
+		inline const Vector& ExtentMin(void) const { return this->m_vExtentMin; }
+		inline const Vector& ExtentMax(void) const { return this->m_vExtentMax; }
+		inline ULONGLONG NextThink(void) const { return this->m_ullNextThink; }
+		inline bool IsSleeping(void) const { return this->m_bSleeping; }
+		inline bool LodEnabled(void) const { return this->m_bLodEnabled; }
+		inline DWORD LodRemoveDelay(void) const { return this->m_dwLodRemoveDelay; }
+		inline unsigned int LodProcessInterval(void) const { return this->m_uiLodProcessInterval; }
+		inline bool IsOffscreen(void) const { return this->m_bOffscreen; }
+		inline ULONGLONG FarSince(void) const { return this->m_ullFarSince; }
+
+		//Setters
+		inline void SetHandle(EntityHandle hHandle) { this->m_hHandle = hHandle; }
+		inline void SetCollisionLayers(unsigned int uiCategory, unsigned int uiMask) { this->m_uiCategory = uiCategory; this->m_uiMask = uiMask; }
+		inline void SetNameId(size_t uiNameId, size_t uiNameSlot) { this->m_uiNameId = uiNameId; this->m_uiNameSlot = uiNameSlot; }
+		inline void SetNextThink(ULONGLONG ullTime) { this->m_ullNextThink = ullTime; this->m_bSleeping = true; }
+		inline void Wake(void) { this->m_bSleeping = false; }
+		inline void SetLodPolicy(bool bEnabled, DWORD dwRemoveDelay, unsigned int uiProcessInterval) { this->m_bLodEnabled = bEnabled; this->m_dwLodRemoveDelay = dwRemoveDelay; this->m_uiLodProcessInterval = (std::max)(1U, uiProcessInterval); if (!bEnabled) { this->m_bOffscreen = false; this->m_ullFarSince = 0; } }
+		inline void SetVisibility(bool bOffscreen, ULONGLONG ullFarSince) { this->m_bOffscreen = bOffscreen; this->m_ullFarSince = ullFarSince; }
+		inline void CacheSelectionInfo(void) { this->m_bMovable = this->IsMovable(); if (this->m_bMovable) this->m_vSelectionSize = this->GetSelectionSize(); }
 	};
 
-	/* Scripted entity manager */
-	class CScriptedEntsMgr {
+	/* Generational slot map of entities */
+	class CEntitySlotMap {
 	private:
-		std::vector<CScriptedEntity*> m_vEnts;
+		struct entity_slot_s {
+			CScriptedEntity* pEntity;
+			size_t uiIndex;
+			unsigned int uiGeneration;
+			size_t uiNextFree;
+		};
 
-		void Release(void)
+		struct object_entry_s {
+			asIScriptObject* pObject;
+			size_t uiSlot;
+		};
+
+		std::vector<entity_slot_s> m_vSlots;
+		size_t m_uiFreeHead;
+		std::vector<object_entry_s> m_vObjectTable; //Open addressing hash table of script objects to slots
+		size_t m_uiObjectCount;
+
+		inline size_t ObjectBucket(asIScriptObject* pObject) const
 		{
-			//Release resources
+			//Hash script object address to table index
 
-			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
-				this->m_vEnts[i]->OnRelease();
-				delete this->m_vEnts[i];
+			unsigned long long ullHash = (unsigned long long)pObject;
+			ullHash ^= ullHash >> 33;
+			ullHash *= 0xFF51AFD7ED558CCDull;
+			ullHash ^= ullHash >> 33;
+
+			return (size_t)ullHash & (this->m_vObjectTable.size() - 1);
+		}
+
+		size_t FindObject(asIScriptObject* pObject) const
+		{
+			//Get table index of a script object
+
+			if (!this->m_vObjectTable.size())
+				return SI_INVALID_ID;
+
+			for (size_t i = this->ObjectBucket(pObject); this->m_vObjectTable[i].pObject; i = (i + 1) & (this->m_vObjectTable.size() - 1)) {
+				if (this->m_vObjectTable[i].pObject == pObject)
+					return i;
+			}
+
+			return SI_INVALID_ID;
+		}
+
+		void InsertObject(asIScriptObject* pObject, size_t uiSlot)
+		{
+			//Add script object to the table, keep load factor below one half
+
+			if ((this->m_uiObjectCount + 1) * 2 > this->m_vObjectTable.size())
+				this->RehashObjects((this->m_vObjectTable.size()) ? this->m_vObjectTable.size() * 2 : 64);
+
+			size_t i = this->ObjectBucket(pObject);
+			while ((this->m_vObjectTable[i].pObject) && (this->m_vObjectTable[i].pObject != pObject)) {
+				i = (i + 1) & (this->m_vObjectTable.size() - 1);
+			}
+
+			if (!this->m_vObjectTable[i].pObject)
+				this->m_uiObjectCount++;
+
+			this->m_vObjectTable[i].pObject = pObject;
+			this->m_vObjectTable[i].uiSlot = uiSlot;
+		}
+
+		void EraseObject(asIScriptObject* pObject)
+		{
+			//Remove script object from the table by shifting back following entries of the probe sequence
+
+			size_t i = this->FindObject(pObject);
+			if (i == SI_INVALID_ID)
+				return;
+
+			size_t uiMask = this->m_vObjectTable.size() - 1;
+			for (size_t j = (i + 1) & uiMask; this->m_vObjectTable[j].pObject; j = (j + 1) & uiMask) {
+				size_t k = this->ObjectBucket(this->m_vObjectTable[j].pObject);
+
+				//Keep entries whose home bucket lies cyclically within (i, j]
+				if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+					continue;
+
+				this->m_vObjectTable[i] = this->m_vObjectTable[j];
+				i = j;
+			}
+
+			this->m_vObjectTable[i].pObject = nullptr;
+			this->m_uiObjectCount--;
+		}
+
+		void RehashObjects(size_t uiTableSize)
+		{
+			//Resize the table (power of two) and re-insert all entries
+
+			std::vector<object_entry_s> vOldTable;
+			vOldTable.swap(this->m_vObjectTable);
+
+			object_entry_s sEmpty;
+			sEmpty.pObject = nullptr;
+			sEmpty.uiSlot = SI_INVALID_ID;
+			this->m_vObjectTable.resize(uiTableSize, sEmpty);
+			this->m_uiObjectCount = 0;
+
+			for (size_t i = 0; i < vOldTable.size(); i++) {
+				if (vOldTable[i].pObject)
+					this->InsertObject(vOldTable[i].pObject, vOldTable[i].uiSlot);
+			}
+		}
+
+		inline size_t SlotOf(EntityHandle hHandle) const { return (size_t)(hHandle & 0xFFFFFFFF); }
+		inline unsigned int GenerationOf(EntityHandle hHandle) const { return (unsigned int)(hHandle >> 32); }
+		inline EntityHandle MakeHandle(size_t uiSlot) const { return ((EntityHandle)this->m_vSlots[uiSlot].uiGeneration << 32) | (EntityHandle)uiSlot; }
+
+		const entity_slot_s* GetSlot(EntityHandle hHandle) const
+		{
+			//Get slot of a handle if it is still alive
+
+			size_t uiSlot = this->SlotOf(hHandle);
+			if (uiSlot >= this->m_vSlots.size())
+				return nullptr;
+
+			const entity_slot_s& rSlot = this->m_vSlots[uiSlot];
+			if ((!rSlot.pEntity) || (rSlot.uiGeneration != this->GenerationOf(hHandle)))
+				return nullptr;
+
+			return &rSlot;
+		}
+	public:
+		CEntitySlotMap() : m_uiFreeHead(SI_INVALID_ID), m_uiObjectCount(0) {}
+		~CEntitySlotMap() {}
+
+		void Reserve(size_t uiEntityCount)
+		{
+			//Preallocate room for the given amount of entities
+
+			this->m_vSlots.reserve(uiEntityCount);
+
+			size_t uiTableSize = 64;
+			while (uiTableSize < uiEntityCount * 2) {
+				uiTableSize *= 2;
+			}
+
+			if (uiTableSize > this->m_vObjectTable.size())
+				this->RehashObjects(uiTableSize);
+		}
+
+		EntityHandle Add(CScriptedEntity* pEntity, size_t uiIndex)
+		{
+			//Occupy a slot for the entity and return its handle
+
+			size_t uiSlot = this->m_uiFreeHead;
+			if (uiSlot != SI_INVALID_ID) {
+				this->m_uiFreeHead = this->m_vSlots[uiSlot].uiNextFree;
+			} else {
+				entity_slot_s sSlot;
+				sSlot.uiGeneration = 0;
+				this->m_vSlots.push_back(sSlot);
+				uiSlot = this->m_vSlots.size() - 1;
+			}
+
+			//Generations start at 1 so that no valid handle equals ENT_INVALID_HANDLE
+			entity_slot_s& rSlot = this->m_vSlots[uiSlot];
+			rSlot.pEntity = pEntity;
+			rSlot.uiIndex = uiIndex;
+			rSlot.uiNextFree = SI_INVALID_ID;
+			if (++rSlot.uiGeneration == 0)
+				rSlot.uiGeneration = 1;
+
+			this->InsertObject(pEntity->Object(), uiSlot);
+
+			return this->MakeHandle(uiSlot);
+		}
+
+		void Remove(EntityHandle hHandle)
+		{
+			//Free the slot of a handle. All copies of the handle become invalid
+
+			if (!this->GetSlot(hHandle))
+				return;
+
+			size_t uiSlot = this->SlotOf(hHandle);
+			entity_slot_s& rSlot = this->m_vSlots[uiSlot];
+
+			this->EraseObject(rSlot.pEntity->Object());
+
+			rSlot.pEntity = nullptr;
+			rSlot.uiIndex = SI_INVALID_ID;
+			rSlot.uiNextFree = this->m_uiFreeHead;
+			this->m_uiFreeHead = uiSlot;
+		}
+
+		void Clear(void)
+		{
+			//Free all slots
+
+			this->m_vSlots.clear();
+			this->m_uiFreeHead = SI_INVALID_ID;
+
+			for (size_t i = 0; i < this->m_vObjectTable.size(); i++) {
+				this->m_vObjectTable[i].pObject = nullptr;
+			}
+			this->m_uiObjectCount = 0;
+		}
+
+		EntityHandle Find(asIScriptObject* pObject) const
+		{
+			//Get handle of an entity by its script object
+
+			size_t uiEntry = this->FindObject(pObject);
+			if (uiEntry == SI_INVALID_ID)
+				return ENT_INVALID_HANDLE;
+
+			return this->MakeHandle(this->m_vObjectTable[uiEntry].uiSlot);
+		}
+
+		//Setters
+		inline void SetIndex(EntityHandle hHandle, size_t uiIndex) { if (this->GetSlot(hHandle)) this->m_vSlots[this->SlotOf(hHandle)].uiIndex = uiIndex; }
+
+		//Getters
+		inline CScriptedEntity* Entity(EntityHandle hHandle) const { const entity_slot_s* pSlot = this->GetSlot(hHandle); return (pSlot) ? pSlot->pEntity : nullptr; }
+		inline size_t Index(EntityHandle hHandle) const { const entity_slot_s* pSlot = this->GetSlot(hHandle); return (pSlot) ? pSlot->uiIndex : SI_INVALID_ID; }
+	};
+
+	/* Interned name table */
+	class CNameTable {
+	private:
+		std::vector<std::string> m_vNames;
+		std::unordered_map<std::string, size_t> m_mIds;
+	public:
+		CNameTable() { this->Intern(""); }
+		~CNameTable() {}
+
+		size_t Intern(const std::string& szName)
+		{
+			//Get the compact ID of a name, add it to the table if not yet known
+
+			std::unordered_map<std::string, size_t>::const_iterator it = this->m_mIds.find(szName);
+			if (it != this->m_mIds.end())
+				return it->second;
+
+			this->m_vNames.push_back(szName);
+			this->m_mIds[szName] = this->m_vNames.size() - 1;
+
+			return this->m_vNames.size() - 1;
+		}
+
+		size_t Find(const std::string& szName) const
+		{
+			//Get the compact ID of a name if known
+
+			std::unordered_map<std::string, size_t>::const_iterator it = this->m_mIds.find(szName);
+			if (it == this->m_mIds.end())
+				return SI_INVALID_ID;
+
+			return it->second;
+		}
+
+		//Getters
+		inline const std::string& Name(const size_t uiNameId) const { return this->m_vNames[uiNameId]; }
+		inline size_t Count(void) const { return this->m_vNames.size(); }
+	};
+
+	/* Per-tick entity attribute snapshot. Rows are kept parallel to the entity list */
+	class CEntitySnapshot {
+	private:
+		std::vector<Vector> m_vPositions;
+		std::vector<Vector> m_vBoundsMin;
+		std::vector<Vector> m_vBoundsMax;
+		std::vector<CModel*> m_vModels;
+		std::vector<byte> m_vDamageTypes;
+		std::vector<size_t> m_vNameIds;
+		std::vector<CScriptedEntity::DamageValue> m_vDamageValues;
+		std::vector<unsigned long long> m_vCategories;
+		std::vector<unsigned long long> m_vMasks;
+		std::vector<byte> m_vMovable;
+	public:
+		CEntitySnapshot() {}
+		~CEntitySnapshot() {}
+
+		void Update(const size_t uiRow, CScriptedEntity* pEntity)
+		{
+			//Query attributes of the entity once and store them in the given row
+
+			this->m_vDamageTypes[uiRow] = pEntity->IsDamageable();
+			this->m_vPositions[uiRow] = pEntity->GetPosition();
+			this->m_vNameIds[uiRow] = pEntity->NameId();
+			this->m_vModels[uiRow] = nullptr;
+			this->m_vDamageValues[uiRow] = 0;
+			this->m_vCategories[uiRow] = pEntity->CollisionCategory() | ENT_SQUAD_LAYER_NONE;
+			this->m_vMasks[uiRow] = (this->m_vDamageTypes[uiRow] != DAMAGEABLE_NO) ? pEntity->CollisionMask() | ENT_SQUAD_LAYERS | ENT_SQUAD_LAYER_NONE : 0; //Non-damageable entities collide with nothing
+			this->m_vMovable[uiRow] = pEntity->Movable();
+
+			//Model and damage value are only relevant for damageable entities
+			if (this->m_vDamageTypes[uiRow]) {
+				this->m_vDamageValues[uiRow] = pEntity->GetDamageValue();
+
+				CModel* pModel = pEntity->GetModel();
+				Vector vMin, vMax;
+
+				//Entities without bbox items can not collide
+				if ((pModel) && (pModel->BBox().GetBounds(vMin, vMax))) {
+					this->m_vModels[uiRow] = pModel;
+					this->m_vBoundsMin[uiRow] = this->m_vPositions[uiRow] + vMin;
+					this->m_vBoundsMax[uiRow] = this->m_vPositions[uiRow] + vMax;
+				}
+			}
+		}
+
+		void SetSquadLayer(const size_t uiRow, unsigned long long ullSquadLayer)
+		{
+			//Put the entity of the row into the given squad layer and remove that layer from its mask, so that members of a squad do not collide
+
+			this->m_vCategories[uiRow] = (this->m_vCategories[uiRow] & ENT_LAYER_ALL) | ullSquadLayer;
+			this->m_vMasks[uiRow] &= ~ullSquadLayer;
+		}
+
+		void Resize(const size_t uiRows)
+		{
+			//Set amount of rows
+
+			this->m_vPositions.resize(uiRows);
+			this->m_vBoundsMin.resize(uiRows);
+			this->m_vBoundsMax.resize(uiRows);
+			this->m_vModels.resize(uiRows, nullptr);
+			this->m_vDamageTypes.resize(uiRows, DAMAGEABLE_NO);
+			this->m_vNameIds.resize(uiRows, 0);
+			this->m_vDamageValues.resize(uiRows, 0);
+			this->m_vCategories.resize(uiRows, ENT_LAYER_DEFAULT | ENT_SQUAD_LAYER_NONE);
+			this->m_vMasks.resize(uiRows, ENT_LAYER_ALL | ENT_SQUAD_LAYERS | ENT_SQUAD_LAYER_NONE);
+			this->m_vMovable.resize(uiRows, false);
+		}
+
+		void Reserve(const size_t uiRows)
+		{
+			//Preallocate room for the given amount of rows
+
+			this->m_vPositions.reserve(uiRows);
+			this->m_vBoundsMin.reserve(uiRows);
+			this->m_vBoundsMax.reserve(uiRows);
+			this->m_vModels.reserve(uiRows);
+			this->m_vDamageTypes.reserve(uiRows);
+			this->m_vNameIds.reserve(uiRows);
+			this->m_vDamageValues.reserve(uiRows);
+			this->m_vCategories.reserve(uiRows);
+			this->m_vMasks.reserve(uiRows);
+			this->m_vMovable.reserve(uiRows);
+		}
+
+		void MoveRow(const size_t uiFrom, const size_t uiTo)
+		{
+			//Move a row to another position, overwriting the target row
+
+			this->m_vPositions[uiTo] = this->m_vPositions[uiFrom];
+			this->m_vBoundsMin[uiTo] = this->m_vBoundsMin[uiFrom];
+			this->m_vBoundsMax[uiTo] = this->m_vBoundsMax[uiFrom];
+			this->m_vModels[uiTo] = this->m_vModels[uiFrom];
+			this->m_vDamageTypes[uiTo] = this->m_vDamageTypes[uiFrom];
+			this->m_vNameIds[uiTo] = this->m_vNameIds[uiFrom];
+			this->m_vDamageValues[uiTo] = this->m_vDamageValues[uiFrom];
+			this->m_vCategories[uiTo] = this->m_vCategories[uiFrom];
+			this->m_vMasks[uiTo] = this->m_vMasks[uiFrom];
+			this->m_vMovable[uiTo] = this->m_vMovable[uiFrom];
+		}
+
+		inline void Clear(void) { this->Resize(0); }
+
+		//Getters
+		inline size_t Count(void) const { return this->m_vPositions.size(); }
+		inline const Vector& Position(const size_t uiRow) const { return this->m_vPositions[uiRow]; }
+		inline const int* PositionData(void) const { return (const int*)this->m_vPositions.data(); } //Interleaved x, y pairs
+		inline const Vector& BoundsMin(const size_t uiRow) const { return this->m_vBoundsMin[uiRow]; }
+		inline const Vector& BoundsMax(const size_t uiRow) const { return this->m_vBoundsMax[uiRow]; }
+		inline CModel* Model(const size_t uiRow) const { return this->m_vModels[uiRow]; }
+		inline byte DamageType(const size_t uiRow) const { return this->m_vDamageTypes[uiRow]; }
+		inline size_t NameId(const size_t uiRow) const { return this->m_vNameIds[uiRow]; }
+		inline CScriptedEntity::DamageValue DamageValue(const size_t uiRow) const { return this->m_vDamageValues[uiRow]; }
+		inline unsigned long long CollisionCategory(const size_t uiRow) const { return this->m_vCategories[uiRow]; }
+		inline unsigned long long CollisionMask(const size_t uiRow) const { return this->m_vMasks[uiRow]; }
+		inline bool Movable(const size_t uiRow) const { return this->m_vMovable[uiRow] != 0; }
+	};
+
+	/* Scripted entity manager */
+	#define ENT_DEFAULT_BUDGET 4096
+	#define ENT_DEFAULT_TICK_RATE 60 //Simulation steps per second, think delays are converted to steps with it
+	#define ENT_POOL_BLOCK_SIZE 256
+	#define ENT_LOD_VISIBLE_MARGIN 128 //Assumed extent of entities without model bounds or selection size
+	#define ENT_LOD_FAR_DISTANCE 512 //Distance to the backbuffer rect from which on entities count as far outside
+	class CScriptedEntsMgr {
+	public:
+		struct query_filter_s {
+			bool bDamageableOnly;
+			bool bMovableOnly;
+			size_t uiExcludeNameId;
+			asIScriptObject* pIgnoreEnt;
+		};
+
+		struct lod_stats_s {
+			unsigned long long ullSkippedProcess;
+			unsigned long long ullSkippedDraw;
+			unsigned long long ullRemoved;
+		};
+	private:
+		CObjectPool<CScriptedEntity, ENT_POOL_BLOCK_SIZE> m_oPool;
+		std::vector<CScriptedEntity*> m_vEnts;
+		std::vector<size_t> m_vPendingRemoval;
+		CEntitySlotMap m_oSlots;
+		CEntitySnapshot m_oSnapshot;
+		CNameTable m_oNames;
+		std::vector<std::vector<CScriptedEntity*>> m_vNameIndex;
+		std::vector<unsigned long long> m_vSquadLayers; //Squad layer per name id, zero if none is assigned
+		unsigned long long m_ullUsedSquadLayers;
+		std::vector<size_t> m_vCandidates;
+		std::vector<int> m_vCandidateBounds[4];
+		std::vector<size_t> m_vOverlapping;
+		std::vector<std::pair<size_t, size_t>> m_vHits;
+		std::vector<std::pair<EntityHandle, EntityHandle>> m_vContacts;
+		std::vector<std::pair<EntityHandle, EntityHandle>> m_vPrevContacts;
+		std::vector<size_t> m_vQueryCandidates;
+		std::vector<std::pair<long long, size_t>> m_vNearest;
+		std::vector<size_t> m_vRadialCandidates;
+		std::vector<std::pair<EntityHandle, CScriptedEntity::DamageValue>> m_vRadialHits; //Hits of nested calls are stacked behind the ones of outer calls
+		CSpatialGrid m_oGrid;
+		CSpatialGrid m_oPosGrid;
+		bool m_bGridDirty;
+		int m_iMaxReach; //Largest distance from the position of a damageable entity to the border of its bounds
+		Vector m_vMaxSelectionSize;
+		std::priority_queue<std::pair<ULONGLONG, EntityHandle>, std::vector<std::pair<ULONGLONG, EntityHandle>>, std::greater<std::pair<ULONGLONG, EntityHandle>>> m_oThinkQueue; //Min-heap of wake up ticks of sleeping entities
+		unsigned long long m_ullTick;
+		unsigned int m_uiTickRate;
+		lod_stats_s m_sLodStats;
+
+		void Release(void)
+		{
+			//Release resources
+
+			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+				this->m_vEnts[i]->OnRelease();
+				this->m_oPool.Delete(this->m_vEnts[i]);
+			}
+
+			this->m_vEnts.clear();
+			this->m_vPrevContacts.clear();
+			this->m_vNameIndex.clear();
+			this->m_vSquadLayers.clear();
+			this->m_ullUsedSquadLayers = 0;
+			this->m_oThinkQueue = decltype(this->m_oThinkQueue)();
+			this->m_oSlots.Clear();
+			this->m_oSnapshot.Clear();
+			this->m_bGridDirty = true;
+		}
+
+		void AddToNameIndex(CScriptedEntity* pEntity)
+		{
+			//Resolve the name of the entity once and add it to the list of live entities with that name
+
+			size_t uiNameId = this->m_oNames.Intern(pEntity->GetName());
+
+			if (uiNameId >= this->m_vNameIndex.size()) {
+				this->m_vNameIndex.resize(uiNameId + 1);
+				this->m_vSquadLayers.resize(uiNameId + 1, 0);
+			}
+
+			pEntity->SetNameId(uiNameId, this->m_vNameIndex[uiNameId].size());
+			this->m_vNameIndex[uiNameId].push_back(pEntity);
+		}
+
+		void RemoveFromNameIndex(CScriptedEntity* pEntity)
+		{
+			//Remove entity from the list of its name by moving the last one into its place
+
+			std::vector<CScriptedEntity*>& rList = this->m_vNameIndex[pEntity->NameId()];
+
+			CScriptedEntity* pLast = rList.back();
+			rList[pEntity->NameSlot()] = pLast;
+			pLast->SetNameId(pLast->NameId(), pEntity->NameSlot());
+			rList.pop_back();
+
+			//Free the squad layer of the name with its last entity
+			if (!rList.size()) {
+				this->m_ullUsedSquadLayers &= ~this->m_vSquadLayers[pEntity->NameId()];
+				this->m_vSquadLayers[pEntity->NameId()] = 0;
+			}
+		}
+
+		unsigned long long SquadLayer(size_t uiNameId)
+		{
+			//Get the squad layer of a name, assign the first free one if it has none yet. If all are in use, squads share layers by name id
+
+			unsigned long long& rLayer = this->m_vSquadLayers[uiNameId];
+
+			if (!rLayer) {
+				for (size_t i = 0; i < ENT_SQUAD_LAYER_COUNT; i++) {
+					unsigned long long ullLayer = 1ULL << (ENT_SQUAD_LAYER_FIRST + i);
+
+					if (!(this->m_ullUsedSquadLayers & ullLayer)) {
+						rLayer = ullLayer;
+						break;
+					}
+				}
+
+				if (!rLayer)
+					rLayer = 1ULL << (ENT_SQUAD_LAYER_FIRST + uiNameId % ENT_SQUAD_LAYER_COUNT);
+
+				this->m_ullUsedSquadLayers |= rLayer;
+			}
+
+			return rLayer;
+		}
+
+		void UpdateSnapshotRow(const size_t uiRow)
+		{
+			//Query attributes of an entity and put it into the layer of its squad if it does not damage its squad
+
+			this->m_oSnapshot.Update(uiRow, this->m_vEnts[uiRow]);
+
+			if (this->m_oSnapshot.DamageType(uiRow) == DAMAGEABLE_NOTSQUAD)
+				this->m_oSnapshot.SetSquadLayer(uiRow, this->SquadLayer(this->m_oSnapshot.NameId(uiRow)));
+		}
+
+		void RemovePending(void)
+		{
+			//Release all entities pending for removal and compact the list once, keeping the draw order
+
+			if (!this->m_vPendingRemoval.size())
+				return;
+
+			//Inform all first, so that entities spawned while releasing are handled by the compaction too
+			for (size_t i = 0; i < this->m_vPendingRemoval.size(); i++) {
+				this->m_vEnts[this->m_vPendingRemoval[i]]->OnRelease();
+			}
+
+			size_t uiPending = 0;
+			size_t uiKept = 0;
+
+			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+				if ((uiPending < this->m_vPendingRemoval.size()) && (this->m_vPendingRemoval[uiPending] == i)) {
+					//Free entity
+					this->RemoveFromNameIndex(this->m_vEnts[i]);
+					this->m_oSlots.Remove(this->m_vEnts[i]->Handle());
+					this->m_oPool.Delete(this->m_vEnts[i]);
+					uiPending++;
+					continue;
+				}
+
+				//Move entity to the next free position
+				if (uiKept != i) {
+					this->m_vEnts[uiKept] = this->m_vEnts[i];
+					this->m_oSnapshot.MoveRow(i, uiKept);
+					this->m_oSlots.SetIndex(this->m_vEnts[uiKept]->Handle(), uiKept);
+				}
+
+				uiKept++;
+			}
+
+			this->m_vEnts.resize(uiKept);
+			this->m_oSnapshot.Resize(uiKept);
+			this->m_vPendingRemoval.clear();
+			this->m_bGridDirty = true;
+		}
+
+		void WakeDueEntities(void)
+		{
+			//Wake all sleeping entities whose think tick has been reached. Entries of removed or rescheduled entities are dropped
+
+			while ((!this->m_oThinkQueue.empty()) && (this->m_oThinkQueue.top().first <= this->m_ullTick)) {
+				std::pair<ULONGLONG, EntityHandle> sEntry = this->m_oThinkQueue.top();
+				this->m_oThinkQueue.pop();
+
+				CScriptedEntity* pEntity = this->m_oSlots.Entity(sEntry.second);
+				if ((pEntity) && (pEntity->IsSleeping()) && (pEntity->NextThink() == sEntry.first)) {
+					pEntity->Wake();
+				}
+			}
+		}
+
+		void UpdateVisibility(void)
+		{
+			//Classify entities that opted in to level of detail against the backbuffer rect. Entities without collision bounds use the extent queried on spawn or are assumed to extend around their position
+
+			if (!pGfxReference)
+				return;
+
+			int iWidth = pGfxReference->GetWindowWidth();
+			int iHeight = pGfxReference->GetWindowHeight();
+			ULONGLONG ullNow = GetTickCount64();
+
+			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+				CScriptedEntity* pEntity = this->m_vEnts[i];
+				if (!pEntity->LodEnabled())
+					continue;
+
+				Vector vMin, vMax;
+
+				if (!this->GetEntityBounds(i, vMin, vMax)) {
+					const Vector& vPos = this->m_oSnapshot.Position(i);
+					vMin = Vector(vPos[0] - ENT_LOD_VISIBLE_MARGIN, vPos[1] - ENT_LOD_VISIBLE_MARGIN);
+					vMax = Vector(vPos[0] + ENT_LOD_VISIBLE_MARGIN, vPos[1] + ENT_LOD_VISIBLE_MARGIN);
+				}
+
+				//Distance of the bounds to the backbuffer rect, zero if they intersect
+				int iDistance = (std::max)((std::max)(-vMax[0], vMin[0] - iWidth), (std::max)(-vMax[1], vMin[1] - iHeight));
+
+				if (iDistance > ENT_LOD_FAR_DISTANCE) {
+					pEntity->SetVisibility(true, (pEntity->FarSince()) ? pEntity->FarSince() : ullNow);
+				} else {
+					pEntity->SetVisibility(iDistance > 0, 0);
+				}
+			}
+		}
+
+		bool ShallRemoveFar(CScriptedEntity* pEntity, ULONGLONG ullNow) const
+		{
+			//Check if the entity opted in to be removed after being far outside for its delay
+
+			return (pEntity->LodRemoveDelay()) && (pEntity->FarSince()) && (ullNow - pEntity->FarSince() >= pEntity->LodRemoveDelay());
+		}
+
+		void UpdateSnapshot(void)
+		{
+			//Query attributes of all entities once for this tick. Sleeping entities keep the row of their last awake tick
+
+			this->m_oSnapshot.Resize(this->m_vEnts.size());
+
+			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+				if (this->m_vEnts[i]->IsSleeping())
+					continue;
+
+				this->UpdateSnapshotRow(i);
+			}
+
+			this->m_bGridDirty = true;
+		}
+
+		void BuildGrid(void)
+		{
+			//Insert all damageable entities of the snapshot into the bbox grid and all entities into the position grid
+
+			size_t uiEntCount = this->m_oSnapshot.Count();
+
+			this->m_oGrid.Clear(uiEntCount);
+			this->m_oPosGrid.Clear(uiEntCount);
+			this->m_iMaxReach = 0;
+
+			for (size_t i = 0; i < uiEntCount; i++) {
+				if (this->m_oSnapshot.Model(i)) {
+					this->m_oGrid.Insert(i, this->m_oSnapshot.BoundsMin(i), this->m_oSnapshot.BoundsMax(i));
+				}
+
+				this->m_oPosGrid.Insert(i, this->m_oSnapshot.Position(i), this->m_oSnapshot.Position(i));
+
+				//Queries by bounds extend the position query by the largest reach
+				Vector vMin, vMax;
+				if ((this->m_oSnapshot.DamageType(i) != DAMAGEABLE_NO) && (this->GetEntityBounds(i, vMin, vMax))) {
+					const Vector& vPos = this->m_oSnapshot.Position(i);
+					int iReach = (std::max)((std::max)(vPos[0] - vMin[0], vMax[0] - vPos[0]), (std::max)(vPos[1] - vMin[1], vMax[1] - vPos[1]));
+					if (iReach > this->m_iMaxReach) this->m_iMaxReach = iReach;
+				}
+			}
+
+			this->m_bGridDirty = false;
+		}
+
+		bool GetEntityBounds(const size_t uiEntity, Vector& vMin, Vector& vMax) const
+		{
+			//Get the screen rectangle of an entity from its model bounds or its cached extent. Returns false if it has neither
+
+			if (this->m_oSnapshot.Model(uiEntity)) {
+				vMin = this->m_oSnapshot.BoundsMin(uiEntity);
+				vMax = this->m_oSnapshot.BoundsMax(uiEntity);
+				return true;
+			}
+
+			if (this->m_vEnts[uiEntity]->HasExtent()) {
+				vMin = this->m_oSnapshot.Position(uiEntity) + this->m_vEnts[uiEntity]->ExtentMin();
+				vMax = this->m_oSnapshot.Position(uiEntity) + this->m_vEnts[uiEntity]->ExtentMax();
+				return true;
+			}
+
+			return false;
+		}
+
+		bool PassesFilter(const size_t uiEntity, const query_filter_s& rFilter) const
+		{
+			//Check if entity matches the query filter
+
+			if ((rFilter.bDamageableOnly) && (this->m_oSnapshot.DamageType(uiEntity) == DAMAGEABLE_NO))
+				return false;
+
+			if ((rFilter.bMovableOnly) && (!this->m_oSnapshot.Movable(uiEntity)))
+				return false;
+
+			if (this->m_oSnapshot.NameId(uiEntity) == rFilter.uiExcludeNameId)
+				return false;
+
+			if ((rFilter.pIgnoreEnt) && (this->m_vEnts[uiEntity]->Object() == rFilter.pIgnoreEnt))
+				return false;
+
+			return true;
+		}
+
+		inline bool LayersMatch(const size_t uiEntity, const size_t uiRefEntity) const
+		{
+			//Check if the category of each entity is contained in the mask of the other one, both in the script layers and in the squad layers
+
+			unsigned long long ullLayers = this->m_oSnapshot.CollisionCategory(uiEntity) & this->m_oSnapshot.CollisionMask(uiRefEntity);
+			unsigned long long ullRefLayers = this->m_oSnapshot.CollisionCategory(uiRefEntity) & this->m_oSnapshot.CollisionMask(uiEntity);
+
+			return ((ullLayers & ENT_LAYER_ALL) != 0) && ((ullLayers & ~(unsigned long long)ENT_LAYER_ALL) != 0) && ((ullRefLayers & ENT_LAYER_ALL) != 0) && ((ullRefLayers & ~(unsigned long long)ENT_LAYER_ALL) != 0);
+		}
+
+		void ProcessCollisions(void)
+		{
+			//Handle collisions between damageable entities using the spatial grid as broad phase
+
+			size_t uiEntCount = this->m_oSnapshot.Count();
+
+			this->BuildGrid();
+
+			this->m_vHits.clear();
+
+			//Check each pair sharing the same cells once
+			for (size_t i = 0; i < uiEntCount; i++) {
+				CModel* pModel = this->m_oSnapshot.Model(i);
+				if (!pModel)
+					continue;
+
+				const Vector& vMin = this->m_oSnapshot.BoundsMin(i);
+				const Vector& vMax = this->m_oSnapshot.BoundsMax(i);
+
+				this->m_oGrid.Query(vMin, vMax, this->m_vCandidates);
+
+				//Gather bounding rectangles of the unchecked candidates
+				for (size_t k = 0; k < 4; k++) {
+					this->m_vCandidateBounds[k].clear();
+				}
+
+				//Layers are checked first, as that is cheaper than the bounds test
+				size_t uiKept = 0;
+				for (size_t k = 0; k < this->m_vCandidates.size(); k++) {
+					size_t j = this->m_vCandidates[k];
+					if ((j <= i) || (!this->LayersMatch(i, j)))
+						continue;
+
+					this->m_vCandidates[uiKept++] = j;
+					this->m_vCandidateBounds[0].push_back(this->m_oSnapshot.BoundsMin(j)[0]);
+					this->m_vCandidateBounds[1].push_back(this->m_oSnapshot.BoundsMin(j)[1]);
+					this->m_vCandidateBounds[2].push_back(this->m_oSnapshot.BoundsMax(j)[0]);
+					this->m_vCandidateBounds[3].push_back(this->m_oSnapshot.BoundsMax(j)[1]);
+				}
+
+				if (!uiKept)
+					continue;
+
+				//Reject candidates whose bounding rectangles do not overlap in one batch
+				RectKernels::rect_columns_s sRects = { this->m_vCandidateBounds[0].data(), this->m_vCandidateBounds[1].data(), this->m_vCandidateBounds[2].data(), this->m_vCandidateBounds[3].data(), uiKept };
+				this->m_vOverlapping.resize(uiKept);
+				size_t uiOverlapping = RectKernels::CollectOverlapping(sRects, vMin[0], vMin[1], vMax[0], vMax[1], this->m_vOverlapping.data());
+
+				for (size_t k = 0; k < uiOverlapping; k++) {
+					size_t j = this->m_vCandidates[this->m_vOverlapping[k]];
+
+					//Collision test is not symmetric, so check both directions
+					if (pModel->IsCollided(this->m_oSnapshot.Position(i), this->m_oSnapshot.Position(j), *this->m_oSnapshot.Model(j))) {
+						this->m_vHits.push_back(std::make_pair(i, j));
+					} else if (this->m_oSnapshot.Model(j)->IsCollided(this->m_oSnapshot.Position(j), this->m_oSnapshot.Position(i), *pModel)) {
+						this->m_vHits.push_back(std::make_pair(i, j));
+					}
+				}
+			}
+
+			//Inform both entities of each colliding pair of being damaged
+			this->m_vContacts.clear();
+			for (size_t i = 0; i < this->m_vHits.size(); i++) {
+				CScriptedEntity* pEntity = this->m_vEnts[this->m_vHits[i].first];
+				CScriptedEntity* pRefEntity = this->m_vEnts[this->m_vHits[i].second];
+
+				pEntity->OnDamage(this->m_oSnapshot.DamageValue(this->m_vHits[i].second));
+				pRefEntity->OnDamage(this->m_oSnapshot.DamageValue(this->m_vHits[i].first));
+
+				//Track contact if of interest for any of both
+				if ((pEntity->HandlesContacts()) || (pRefEntity->HandlesContacts())) {
+					EntityHandle hEntity = pEntity->Handle();
+					EntityHandle hRefEntity = pRefEntity->Handle();
+
+					this->m_vContacts.push_back((hEntity < hRefEntity) ? std::make_pair(hEntity, hRefEntity) : std::make_pair(hRefEntity, hEntity));
+				}
+			}
+
+			this->ProcessContacts();
+		}
+
+		void SendContactEvent(EntityHandle hEntity, EntityHandle hRefEntity, ContactPhase ePhase)
+		{
+			//Inform both entities of a contact event. Entities removed in the meantime are passed as null
+
+			CScriptedEntity* pEntity = this->m_oSlots.Entity(hEntity);
+			CScriptedEntity* pRefEntity = this->m_oSlots.Entity(hRefEntity);
+
+			if (pEntity)
+				pEntity->OnContact((pRefEntity) ? pRefEntity->Object() : nullptr, ePhase);
+
+			if (pRefEntity)
+				pRefEntity->OnContact((pEntity) ? pEntity->Object() : nullptr, ePhase);
+		}
+
+		void ProcessContacts(void)
+		{
+			//Compare contacts with the ones of the previous tick and send begin, stay and end events
+
+			std::sort(this->m_vContacts.begin(), this->m_vContacts.end());
+
+			size_t uiCur = 0, uiPrev = 0;
+			while ((uiCur < this->m_vContacts.size()) || (uiPrev < this->m_vPrevContacts.size())) {
+				if ((uiPrev >= this->m_vPrevContacts.size()) || ((uiCur < this->m_vContacts.size()) && (this->m_vContacts[uiCur] < this->m_vPrevContacts[uiPrev]))) {
+					this->SendContactEvent(this->m_vContacts[uiCur].first, this->m_vContacts[uiCur].second, CONTACT_BEGIN);
+					uiCur++;
+				} else if ((uiCur >= this->m_vContacts.size()) || (this->m_vPrevContacts[uiPrev] < this->m_vContacts[uiCur])) {
+					this->SendContactEvent(this->m_vPrevContacts[uiPrev].first, this->m_vPrevContacts[uiPrev].second, CONTACT_END);
+					uiPrev++;
+				} else {
+					this->SendContactEvent(this->m_vContacts[uiCur].first, this->m_vContacts[uiCur].second, CONTACT_STAY);
+					uiCur++;
+					uiPrev++;
+				}
 			}
 
-			this->m_vEnts.clear();
+			this->m_vPrevContacts.swap(this->m_vContacts);
 		}
 	public:
-		CScriptedEntsMgr() {}
+		CScriptedEntsMgr() : m_ullUsedSquadLayers(0), m_bGridDirty(true), m_iMaxReach(0), m_vMaxSelectionSize(0, 0), m_ullTick(0), m_uiTickRate(ENT_DEFAULT_TICK_RATE) { memset(&this->m_sLodStats, 0x00, sizeof(this->m_sLodStats)); this->SetBudget(ENT_DEFAULT_BUDGET); }
 		~CScriptedEntsMgr() { this->Release(); }
 
 		bool Spawn(const Scripting::HSISCRIPT hScript, asIScriptObject* pObject, const Vector& vAtPos)
@@ -935,69 +2562,101 @@ namespace Entity {
 			//Spawn new entity
 
 			//Instantiate entity object
-			CScriptedEntity* pEntity = new CScriptedEntity(hScript, pObject);
+			CScriptedEntity* pEntity = this->m_oPool.New(hScript, pObject);
 			if (!pEntity)
 				return false;
 
 			//Check if ready
 			if (!pEntity->IsReady()) {
-				delete pEntity;
+				this->m_oPool.Delete(pEntity);
 				return false;
 			}
 
 			//Inform of being spawned
 			pEntity->OnSpawn(vAtPos);
 
+			//Movable indicator, selection size and extent are queried once
+			pEntity->CacheSelectionInfo();
+			pEntity->CacheExtent();
+			if (pEntity->Movable()) {
+				if (pEntity->SelectionSize()[0] > this->m_vMaxSelectionSize[0]) this->m_vMaxSelectionSize[0] = pEntity->SelectionSize()[0];
+				if (pEntity->SelectionSize()[1] > this->m_vMaxSelectionSize[1]) this->m_vMaxSelectionSize[1] = pEntity->SelectionSize()[1];
+			}
+
 			//Add to list
 			this->m_vEnts.push_back(pEntity);
+			pEntity->SetHandle(this->m_oSlots.Add(pEntity, this->m_vEnts.size() - 1));
+			this->AddToNameIndex(pEntity);
+
+			//Add snapshot row
+			this->m_oSnapshot.Resize(this->m_vEnts.size());
+			this->UpdateSnapshotRow(this->m_vEnts.size() - 1);
+			this->m_bGridDirty = true;
 
 			return true;
 		}
 
+		void SetBudget(size_t uiEntityCount)
+		{
+			//Preallocate entity records and bookkeeping for the given amount of entities
+
+			this->m_oPool.Reserve(uiEntityCount);
+			this->m_vEnts.reserve(uiEntityCount);
+			this->m_vPendingRemoval.reserve(uiEntityCount);
+			this->m_oSlots.Reserve(uiEntityCount);
+			this->m_oSnapshot.Reserve(uiEntityCount);
+		}
+
+		void SetTickRate(unsigned int uiTickRate)
+		{
+			//Set the amount of simulation steps per second, used to convert think delays to steps
+
+			if (uiTickRate)
+				this->m_uiTickRate = uiTickRate;
+		}
+
 		void Process(void)
 		{
 			//Inform entities
+
+			this->m_ullTick++;
+
+			this->WakeDueEntities();
 			
 			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
-				//Let entity process
+				//Let entity process unless it sleeps until its next think time
+				if (this->m_vEnts[i]->IsSleeping())
+					continue;
+
+				//Process off-screen entities at the reduced rate they opted in to, spread over the ticks
+				if ((this->m_vEnts[i]->IsOffscreen()) && ((this->m_ullTick + i) % this->m_vEnts[i]->LodProcessInterval())) {
+					this->m_sLodStats.ullSkippedProcess++;
+					continue;
+				}
+
 				this->m_vEnts[i]->OnProcess();
+			}
 
-				//Handle damaging
-				byte ucDamageType = this->m_vEnts[i]->IsDamageable(); //Query damage type
-				if (ucDamageType) {
-					//Query model
-					CModel* pModel = this->m_vEnts[i]->GetModel();
-					if (pModel) {
-						//Check for collisions with any other entities
-						for (size_t j = 0; j < this->m_vEnts.size(); j++) {
-							if ((j != i) && (this->m_vEnts[j]->IsDamageable())) {
-								//Check if entity does not damage other entities with the same name and ignore damage handling then
-								if (ucDamageType == DAMAGEABLE_NOTSQUAD) {
-									if (this->m_vEnts[i]->GetName() == this->m_vEnts[j]->GetName())
-										continue;
-								}
-
-								CModel* pRef = this->m_vEnts[j]->GetModel();
-								if (pRef) {
-									//Check if collided
-									if (pModel->IsCollided(this->m_vEnts[i]->GetPosition(), this->m_vEnts[j]->GetPosition(), *pRef)) {
-										//Inform both of being damaged
-										this->m_vEnts[i]->OnDamage(this->m_vEnts[j]->GetDamageValue());
-										this->m_vEnts[j]->OnDamage(this->m_vEnts[i]->GetDamageValue());
-									}
-								}
-							}
-						}
-					}
-				}
+			//Query entity attributes for this tick
+			this->UpdateSnapshot();
+			this->UpdateVisibility();
+
+			//Handle damaging
+			this->ProcessCollisions();
 
-				//Check for removal
-				if (this->m_vEnts[i]->NeedsRemoval()) {
-					this->m_vEnts[i]->OnRelease();
-					delete this->m_vEnts[i];
-					this->m_vEnts.erase(this->m_vEnts.begin() + i);
+			ULONGLONG ullNow = GetTickCount64();
+
+			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+				//Check for removal. Sleeping entities are asked again in the tick they wake up
+				if ((!this->m_vEnts[i]->IsSleeping()) && (this->m_vEnts[i]->NeedsRemoval())) {
+					this->m_vPendingRemoval.push_back(i);
+				} else if (this->ShallRemoveFar(this->m_vEnts[i], ullNow)) {
+					this->m_vPendingRemoval.push_back(i);
+					this->m_sLodStats.ullRemoved++;
 				}
 			}
+
+			this->RemovePending();
 		}
 
 		void Draw(void)
@@ -1005,6 +2664,11 @@ namespace Entity {
 			//Inform entities
 
 			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+				if (this->m_vEnts[i]->IsOffscreen()) {
+					this->m_sLodStats.ullSkippedDraw++;
+					continue;
+				}
+
 				this->m_vEnts[i]->OnDraw();
 			}
 		}
@@ -1014,6 +2678,11 @@ namespace Entity {
 			//Inform entities
 
 			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+				if (this->m_vEnts[i]->IsOffscreen()) {
+					this->m_sLodStats.ullSkippedDraw++;
+					continue;
+				}
+
 				this->m_vEnts[i]->OnDrawOnTop();
 			}
 		}
@@ -1024,15 +2693,218 @@ namespace Entity {
 
 			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
 				if (this->m_vEnts[i]->DoUserCleaning()) {
-					this->m_vEnts[i]->OnRelease();
-					delete this->m_vEnts[i];
-					this->m_vEnts.erase(this->m_vEnts.begin() + i);
+					this->m_vPendingRemoval.push_back(i);
 				}
 			}
+
+			this->RemovePending();
 		}
 
 		//Entity querying
 		size_t GetEntityCount() { return this->m_vEnts.size(); }
+		const CEntitySnapshot& Snapshot() const { return this->m_oSnapshot; }
+		const pool_stats_s& PoolStats() const { return this->m_oPool.Stats(); }
+		const lod_stats_s& LodStats() const { return this->m_sLodStats; }
+		CSpatialGrid& Grid()
+		{
+			//Get the grid of damageable entities, rebuild it if entities have been added or removed since
+
+			if (this->m_bGridDirty)
+				this->BuildGrid();
+
+			return this->m_oGrid;
+		}
+		query_filter_s MakeFilter(bool bDamageableOnly, const std::string& szExcludeName, asIScriptObject* pIgnoreEnt) const
+		{
+			//Setup a query filter. An empty name does not exclude any entity
+
+			query_filter_s sFilter;
+			sFilter.bDamageableOnly = bDamageableOnly;
+			sFilter.bMovableOnly = false;
+			sFilter.uiExcludeNameId = (szExcludeName.length()) ? this->m_oNames.Find(szExcludeName) : SI_INVALID_ID;
+			sFilter.pIgnoreEnt = pIgnoreEnt;
+
+			return sFilter;
+		}
+		void QueryBox(const Vector& vMin, const Vector& vMax, const query_filter_s& rFilter, std::vector<size_t>& vOut)
+		{
+			//Get IDs of all entities positioned inside the rectangle
+
+			vOut.clear();
+
+			if (this->m_bGridDirty)
+				this->BuildGrid();
+
+			int iMaxSpan = this->m_oPosGrid.CellSize() * ENT_SPATIAL_MAX_CELL_SPAN;
+			if ((vMax[0] - vMin[0] >= iMaxSpan) || (vMax[1] - vMin[1] >= iMaxSpan)) {
+				//Rectangle exceeds the grid query range, check all entity positions in one batch
+				this->m_vQueryCandidates.resize(this->m_oSnapshot.Count());
+				this->m_vQueryCandidates.resize(RectKernels::CollectContained(this->m_oSnapshot.PositionData(), this->m_oSnapshot.Count(), vMin[0], vMin[1], vMax[0], vMax[1], this->m_vQueryCandidates.data()));
+			} else {
+				this->m_oPosGrid.Query(vMin, vMax, this->m_vQueryCandidates);
+			}
+
+			for (size_t i = 0; i < this->m_vQueryCandidates.size(); i++) {
+				size_t uiEntity = this->m_vQueryCandidates[i];
+				const Vector& vPos = this->m_oSnapshot.Position(uiEntity);
+
+				if ((vPos[0] >= vMin[0]) && (vPos[0] <= vMax[0]) && (vPos[1] >= vMin[1]) && (vPos[1] <= vMax[1]) && (this->PassesFilter(uiEntity, rFilter))) {
+					vOut.push_back(uiEntity);
+				}
+			}
+		}
+		void QueryRadius(const Vector& vOrigin, int iRadius, const query_filter_s& rFilter, std::vector<size_t>& vOut)
+		{
+			//Get IDs of all entities positioned inside the circle
+
+			vOut.clear();
+
+			if (iRadius < 0)
+				return;
+
+			this->QueryBox(Vector(vOrigin[0] - iRadius, vOrigin[1] - iRadius), Vector(vOrigin[0] + iRadius, vOrigin[1] + iRadius), rFilter, vOut);
+
+			//Remove entities in the corners of the rectangle
+			long long llRadiusSq = (long long)iRadius * iRadius;
+			size_t uiKept = 0;
+			for (size_t i = 0; i < vOut.size(); i++) {
+				const Vector& vPos = this->m_oSnapshot.Position(vOut[i]);
+				long long llDistX = vPos[0] - vOrigin[0];
+				long long llDistY = vPos[1] - vOrigin[1];
+
+				if (llDistX * llDistX + llDistY * llDistY <= llRadiusSq) {
+					vOut[uiKept++] = vOut[i];
+				}
+			}
+			vOut.resize(uiKept);
+		}
+		void FindNearest(const Vector& vOrigin, int iMaxRange, const query_filter_s& rFilter, size_t uiCount, std::vector<size_t>& vOut)
+		{
+			//Get IDs of up to the given amount of entities nearest to the origin, ordered by distance. A range of zero or less is unlimited
+
+			vOut.clear();
+
+			if (!uiCount)
+				return;
+
+			if (this->m_bGridDirty)
+				this->BuildGrid();
+
+			int iMaxSpan = this->m_oPosGrid.CellSize() * ENT_SPATIAL_MAX_CELL_SPAN;
+
+			//Search growing circles until enough entities have been found
+			for (int iRadius = this->m_oPosGrid.CellSize(); ; iRadius *= 2) {
+				bool bLastRadius = false;
+
+				if ((iMaxRange > 0) && (iRadius >= iMaxRange)) {
+					iRadius = iMaxRange;
+					bLastRadius = true;
+				}
+
+				if (iRadius * 2 >= iMaxSpan) {
+					//Circle exceeds the grid query range, check all entities in range
+					for (size_t i = 0; i < this->m_oSnapshot.Count(); i++) {
+						if (this->PassesFilter(i, rFilter))
+							vOut.push_back(i);
+					}
+
+					break;
+				}
+
+				this->QueryRadius(vOrigin, iRadius, rFilter, vOut);
+
+				//All entities outside the circle are farther away than the ones inside
+				if ((vOut.size() >= uiCount) || (bLastRadius))
+					break;
+			}
+
+			//Sort by squared distance
+			this->m_vNearest.clear();
+			for (size_t i = 0; i < vOut.size(); i++) {
+				const Vector& vPos = this->m_oSnapshot.Position(vOut[i]);
+				long long llDistX = vPos[0] - vOrigin[0];
+				long long llDistY = vPos[1] - vOrigin[1];
+				long long llDistSq = llDistX * llDistX + llDistY * llDistY;
+
+				if ((iMaxRange <= 0) || (llDistSq <= (long long)iMaxRange * iMaxRange)) {
+					this->m_vNearest.push_back(std::make_pair(llDistSq, vOut[i]));
+				}
+			}
+
+			if (uiCount > this->m_vNearest.size())
+				uiCount = this->m_vNearest.size();
+
+			std::partial_sort(this->m_vNearest.begin(), this->m_vNearest.begin() + uiCount, this->m_vNearest.end());
+
+			vOut.clear();
+			for (size_t i = 0; i < uiCount; i++) {
+				vOut.push_back(this->m_vNearest[i].second);
+			}
+		}
+		size_t ApplyRadialDamage(const Vector& vOrigin, int iRadius, CScriptedEntity::DamageValue dvDamage, float flFalloff, const query_filter_s& rFilter, std::vector<EntityHandle>* pVictims)
+		{
+			//Damage all damageable entities whose bounds reach into the circle, entities without bounds count with their position. The damage decreases linearly
+			//by the falloff fraction towards the border, measured to the closest point of the bounds. All victims are gathered before they are informed,
+			//so that entities spawned or removed by OnDamage do not affect this call. Returns the amount of damaged entities
+
+			if (iRadius < 0)
+				return 0;
+
+			if (this->m_bGridDirty)
+				this->BuildGrid();
+
+			//Bounds of entities positioned farther away than the largest reach can not touch the circle
+			int iReach = iRadius + this->m_iMaxReach;
+			this->QueryBox(Vector(vOrigin[0] - iReach, vOrigin[1] - iReach), Vector(vOrigin[0] + iReach, vOrigin[1] + iReach), rFilter, this->m_vRadialCandidates);
+
+			size_t uiFirstHit = this->m_vRadialHits.size();
+
+			for (size_t i = 0; i < this->m_vRadialCandidates.size(); i++) {
+				size_t uiEntity = this->m_vRadialCandidates[i];
+				Vector vClosest = this->m_oSnapshot.Position(uiEntity);
+				Vector vMin, vMax;
+
+				if (this->GetEntityBounds(uiEntity, vMin, vMax))
+					vClosest = Vector((std::min)((std::max)(vOrigin[0], vMin[0]), vMax[0]), (std::min)((std::max)(vOrigin[1], vMin[1]), vMax[1]));
+
+				float flDistX = (float)(vClosest[0] - vOrigin[0]);
+				float flDistY = (float)(vClosest[1] - vOrigin[1]);
+				float flDistance = sqrtf(flDistX * flDistX + flDistY * flDistY);
+
+				if (flDistance > (float)iRadius)
+					continue;
+
+				float flScale = (iRadius > 0) ? 1.0f - flFalloff * (flDistance / (float)iRadius) : 1.0f;
+
+				int iDamage = (int)((float)dvDamage * flScale + 0.5f);
+				if (iDamage <= 0)
+					continue;
+
+				this->m_vRadialHits.push_back(std::make_pair(this->m_vEnts[uiEntity]->Handle(), (CScriptedEntity::DamageValue)(std::min)(iDamage, 255)));
+			}
+
+			//Inform victims in one batch. OnDamage may apply radial damage again, the hits of that call are added and removed behind these
+			size_t uiLastHit = this->m_vRadialHits.size();
+			size_t uiDamaged = 0;
+
+			for (size_t i = uiFirstHit; i < uiLastHit; i++) {
+				std::pair<EntityHandle, CScriptedEntity::DamageValue> sHit = this->m_vRadialHits[i];
+
+				CScriptedEntity* pEntity = this->m_oSlots.Entity(sHit.first);
+				if (!pEntity)
+					continue;
+
+				pEntity->OnDamage(sHit.second);
+				uiDamaged++;
+
+				if (pVictims)
+					pVictims->push_back(sHit.first);
+			}
+
+			this->m_vRadialHits.resize(uiFirstHit);
+
+			return uiDamaged;
+		}
 		CScriptedEntity* GetEntity(size_t uiEntityId)
 		{
 			if (uiEntityId >= this->m_vEnts.size())
@@ -1052,115 +2924,498 @@ namespace Entity {
 		}
 		bool IsValidEntity(asIScriptObject* pEntity)
 		{
-			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
-				if (this->m_vEnts[i]->Object() == pEntity)
-					return true;
+			return this->m_oSlots.Find(pEntity) != ENT_INVALID_HANDLE;
+		}
+		size_t GetEntityId(asIScriptObject* pEntity)
+		{
+			return this->m_oSlots.Index(this->m_oSlots.Find(pEntity));
+		}
+		EntityHandle GetHandle(asIScriptObject* pEntity)
+		{
+			return this->m_oSlots.Find(pEntity);
+		}
+		CScriptedEntity* GetEntityByHandle(EntityHandle hEntity)
+		{
+			return this->m_oSlots.Entity(hEntity);
+		}
+		size_t GetEntityIndex(EntityHandle hEntity)
+		{
+			return this->m_oSlots.Index(hEntity);
+		}
+		const Vector& MaxSelectionSize() const { return this->m_vMaxSelectionSize; }
+		bool IsValidHandle(EntityHandle hEntity)
+		{
+			return this->m_oSlots.Entity(hEntity) != nullptr;
+		}
+		const std::vector<CScriptedEntity*>* GetEntitiesByName(const std::string& szName) const
+		{
+			//Get all live entities with the given name, nullptr if no entity ever had this name
+
+			size_t uiNameId = this->m_oNames.Find(szName);
+			if ((uiNameId == SI_INVALID_ID) || (uiNameId >= this->m_vNameIndex.size()))
+				return nullptr;
+
+			return &this->m_vNameIndex[uiNameId];
+		}
+
+		size_t CountByName(const std::string& szName) const
+		{
+			//Get amount of live entities with the given name
+
+			const std::vector<CScriptedEntity*>* pList = this->GetEntitiesByName(szName);
+
+			return (pList) ? pList->size() : 0;
+		}
+
+		bool SetCollisionLayers(asIScriptObject* pEntity, unsigned int uiCategory, unsigned int uiMask)
+		{
+			CScriptedEntity* pScriptedEntity = this->m_oSlots.Entity(this->m_oSlots.Find(pEntity));
+			if (!pScriptedEntity)
+				return false;
+
+			pScriptedEntity->SetCollisionLayers(uiCategory, uiMask);
+
+			return true;
+		}
+
+		bool SetLodPolicy(asIScriptObject* pEntity, bool bEnabled, unsigned int uiRemoveDelay, unsigned int uiProcessInterval)
+		{
+			//Set whether the entity is drawn while off-screen, every how many ticks it is processed then (one for every tick) and after what time far outside it is removed (zero for never)
+
+			CScriptedEntity* pScriptedEntity = this->m_oSlots.Entity(this->m_oSlots.Find(pEntity));
+			if (!pScriptedEntity)
+				return false;
+
+			pScriptedEntity->SetLodPolicy(bEnabled, uiRemoveDelay, uiProcessInterval);
+
+			return true;
+		}
+
+		bool SetNextThink(asIScriptObject* pEntity, unsigned int uiMilliseconds)
+		{
+			//Let entity sleep for the given time. OnProcess is not called until then, zero wakes it up again.
+			//The time is counted in simulation steps, rounded up, so that wake ups do not depend on frame times and stop while the simulation does
+
+			CScriptedEntity* pScriptedEntity = this->m_oSlots.Entity(this->m_oSlots.Find(pEntity));
+			if (!pScriptedEntity)
+				return false;
+
+			if (!uiMilliseconds) {
+				pScriptedEntity->Wake();
+				return true;
+			}
+
+			ULONGLONG ullTick = this->m_ullTick + ((unsigned long long)uiMilliseconds * this->m_uiTickRate + 999) / 1000;
+
+			pScriptedEntity->SetNextThink(ullTick);
+			this->m_oThinkQueue.push(std::make_pair(ullTick, pScriptedEntity->Handle()));
+
+			return true;
+		}
+	};
+
+	extern CScriptedEntsMgr oScriptedEntMgr;
+
+	class CEntityTrace { //Entity tracing utility class
+	private:
+		struct tracedata_s {
+			Vector vStart;
+			Vector vEnd;
+			asIScriptObject* pIgnoreEnt;
+		};
+
+		class CLineTest { //Narrow phase test of a line against a damageable entity
+		private:
+			const tracedata_s& m_rTraceData;
+			const CEntitySnapshot& m_rSnapshot;
+		public:
+			CLineTest(const tracedata_s& rTraceData, const CEntitySnapshot& rSnapshot) : m_rTraceData(rTraceData), m_rSnapshot(rSnapshot) {}
+
+			bool operator()(size_t uiEntity, float& flFraction) const
+			{
+				//Check if the line enters the bbox of the entity
+
+				CModel* pModel = this->m_rSnapshot.Model(uiEntity);
+				if (!pModel)
+					return false;
+
+				//Reject by the enclosing rectangle first
+				if (!CBoundingBox::ClipLine(this->m_rTraceData.vStart, this->m_rTraceData.vEnd, this->m_rSnapshot.BoundsMin(uiEntity), this->m_rSnapshot.BoundsMax(uiEntity), flFraction))
+					return false;
+
+				CScriptedEntity* pEntity = oScriptedEntMgr.GetEntity(uiEntity);
+				if ((!pEntity) || (pEntity->Object() == this->m_rTraceData.pIgnoreEnt))
+					return false;
+
+				return pModel->BBox().LineIntersect(this->m_rSnapshot.Position(uiEntity), this->m_rTraceData.vStart, this->m_rTraceData.vEnd, flFraction);
+			}
+		};
+
+		std::vector<CScriptedEntity*> m_vEntities;
+		tracedata_s m_sTraceData;
+		float m_flHitFraction;
+	public:
+		CEntityTrace() : m_flHitFraction(1.0f) {}
+		CEntityTrace(const Vector& vStart, const Vector& vEnd, asIScriptObject* pIgnoreEnt) : m_flHitFraction(1.0f)
+		{
+			this->SetStart(vStart);
+			this->SetEnd(vEnd);
+			this->SetIgnoredEnt(pIgnoreEnt);
+			this->Run();
+		}
+		~CEntityTrace() { this->m_vEntities.clear(); }
+
+		//Action
+		void Run(void)
+		{
+			//Run trace computation
+
+			this->m_vEntities.clear();
+			this->m_flHitFraction = 1.0f;
+
+			if (this->m_sTraceData.vStart == this->m_sTraceData.vEnd)
+				return;
+
+			//Walk the grid cells along the line and keep the nearest entity hit
+			CLineTest oLineTest(this->m_sTraceData, oScriptedEntMgr.Snapshot());
+			size_t uiHitEntity;
+			if (oScriptedEntMgr.Grid().TraceLine(this->m_sTraceData.vStart, this->m_sTraceData.vEnd, oLineTest, uiHitEntity, this->m_flHitFraction)) {
+				//Add to list
+				this->m_vEntities.push_back(oScriptedEntMgr.GetEntity(uiHitEntity));
+			}
+		}
+
+		//Setters
+		inline void SetStart(const Vector& vVector) { this->m_sTraceData.vStart = vVector; }
+		inline void SetEnd(const Vector& vVector) { this->m_sTraceData.vEnd = vVector; }
+		inline void SetIgnoredEnt(asIScriptObject* pIgnoreEnt) { this->m_sTraceData.pIgnoreEnt = pIgnoreEnt; }
+
+		//Getters
+		inline const bool IsEmpty(void) const { return this->m_vEntities.size() == 0; }
+		inline asIScriptObject* EntityObject(const size_t uiId) { if (uiId >= this->m_vEntities.size()) return nullptr; return this->m_vEntities[uiId]->Object(); }
+		inline const size_t EntityCount(void) const { return this->m_vEntities.size(); }
+		inline float HitFraction(void) const { return this->m_flHitFraction; }
+		Vector HitPosition(void) const
+		{
+			return Vector(this->m_sTraceData.vStart[0] + (int)((this->m_sTraceData.vEnd[0] - this->m_sTraceData.vStart[0]) * this->m_flHitFraction), this->m_sTraceData.vStart[1] + (int)((this->m_sTraceData.vEnd[1] - this->m_sTraceData.vStart[1]) * this->m_flHitFraction));
+		}
+		int HitDistance(void) const
+		{
+			Vector vStart(this->m_sTraceData.vStart);
+			return vStart.Distance(this->HitPosition());
+		}
+	};
+
+	/* Flow field component. Steering directions towards a goal on a coarse grid over the window */
+	#define ENT_FLOW_CELL_SIZE 32
+	#define ENT_FLOW_COST_STRAIGHT 10
+	#define ENT_FLOW_COST_DIAGONAL 14
+	#define ENT_FLOW_UNREACHED ((unsigned int)-1)
+	class CFlowField {
+	private:
+		int m_iWidth;
+		int m_iHeight;
+		Vector m_vGoal;
+		std::vector<unsigned int> m_vCosts;
+		std::vector<byte> m_vBlocked;
+		std::vector<signed char> m_vDirections; //Index into the neighbour table, -1 if none
+		bool m_bBuilt;
+
+		static const int* NeighbourOffset(int iDirection)
+		{
+			//Get cell offset of the given neighbour. Straight neighbours come first
+
+			static const int iaOffsets[8][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+			return iaOffsets[iDirection];
+		}
+
+		static inline int CellCoord(int iValue) { return (iValue >= 0) ? iValue / ENT_FLOW_CELL_SIZE : -((-iValue + ENT_FLOW_CELL_SIZE - 1) / ENT_FLOW_CELL_SIZE); } //Floored, so that negative values do not fall into the first cell
+		inline bool IsInside(int x, int y) const { return (x >= 0) && (y >= 0) && (x < this->m_iWidth) && (y < this->m_iHeight); }
+		inline size_t Cell(int x, int y) const { return (size_t)y * this->m_iWidth + x; }
+
+		bool IsPassable(int x, int y, int iDirection) const
+		{
+			//Check if the neighbour can be entered. Diagonal steps must not cut blocked corners
+
+			const int* pOffset = NeighbourOffset(iDirection);
+			int nx = x + pOffset[0], ny = y + pOffset[1];
+
+			if ((!this->IsInside(nx, ny)) || (this->m_vBlocked[this->Cell(nx, ny)]))
+				return false;
+
+			if (iDirection >= 4)
+				return (!this->m_vBlocked[this->Cell(nx, y)]) && (!this->m_vBlocked[this->Cell(x, ny)]);
+
+			return true;
+		}
+	public:
+		CFlowField() : m_iWidth(0), m_iHeight(0), m_vGoal(0, 0), m_bBuilt(false) {}
+		~CFlowField() {}
+
+		void Reset(int iAreaWidth, int iAreaHeight, const Vector& vGoal)
+		{
+			//Setup an empty grid covering the area
+
+			this->m_iWidth = (std::max)(1, (iAreaWidth + ENT_FLOW_CELL_SIZE - 1) / ENT_FLOW_CELL_SIZE);
+			this->m_iHeight = (std::max)(1, (iAreaHeight + ENT_FLOW_CELL_SIZE - 1) / ENT_FLOW_CELL_SIZE);
+			this->m_vGoal = vGoal;
+			this->m_vBlocked.assign((size_t)this->m_iWidth * this->m_iHeight, 0);
+			this->m_bBuilt = false;
+		}
+
+		void Block(const Vector& vMin, const Vector& vMax)
+		{
+			//Mark all cells touched by the rectangle as not passable
+
+			int x0 = CellCoord(vMin[0]), x1 = CellCoord(vMax[0]);
+			int y0 = CellCoord(vMin[1]), y1 = CellCoord(vMax[1]);
+
+			if ((x1 < 0) || (y1 < 0) || (x0 >= this->m_iWidth) || (y0 >= this->m_iHeight))
+				return; //Fully outside of the field
+
+			x0 = (std::max)(0, x0); x1 = (std::min)(this->m_iWidth - 1, x1);
+			y0 = (std::max)(0, y0); y1 = (std::min)(this->m_iHeight - 1, y1);
+
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					this->m_vBlocked[this->Cell(x, y)] = 1;
+				}
+			}
+		}
+
+		void Build(void)
+		{
+			//Calculate the path cost of each cell towards the goal (Dijkstra) and store the cheapest direction per cell
+
+			size_t uiCells = (size_t)this->m_iWidth * this->m_iHeight;
+			this->m_vCosts.assign(uiCells, ENT_FLOW_UNREACHED);
+			this->m_vDirections.assign(uiCells, -1);
+
+			int iGoalX = (std::min)((std::max)(0, CellCoord(this->m_vGoal[0])), this->m_iWidth - 1);
+			int iGoalY = (std::min)((std::max)(0, CellCoord(this->m_vGoal[1])), this->m_iHeight - 1);
+
+			//The goal is always reachable
+			this->m_vBlocked[this->Cell(iGoalX, iGoalY)] = 0;
+			this->m_vCosts[this->Cell(iGoalX, iGoalY)] = 0;
+
+			typedef std::pair<unsigned int, size_t> open_entry_t;
+			std::priority_queue<open_entry_t, std::vector<open_entry_t>, std::greater<open_entry_t>> oOpen;
+			oOpen.push(std::make_pair(0U, this->Cell(iGoalX, iGoalY)));
+
+			while (!oOpen.empty()) {
+				open_entry_t sEntry = oOpen.top();
+				oOpen.pop();
+
+				if (sEntry.first != this->m_vCosts[sEntry.second])
+					continue; //Outdated entry
+
+				int x = (int)(sEntry.second % this->m_iWidth);
+				int y = (int)(sEntry.second / this->m_iWidth);
+
+				for (int i = 0; i < 8; i++) {
+					if (!this->IsPassable(x, y, i))
+						continue;
+
+					const int* pOffset = NeighbourOffset(i);
+					size_t uiNeighbour = this->Cell(x + pOffset[0], y + pOffset[1]);
+					unsigned int uiCost = sEntry.first + ((i < 4) ? ENT_FLOW_COST_STRAIGHT : ENT_FLOW_COST_DIAGONAL);
+
+					if (uiCost < this->m_vCosts[uiNeighbour]) {
+						this->m_vCosts[uiNeighbour] = uiCost;
+						oOpen.push(std::make_pair(uiCost, uiNeighbour));
+					}
+				}
 			}
 
-			return false;
+			//Point each reached cell to its cheapest neighbour
+			for (int y = 0; y < this->m_iHeight; y++) {
+				for (int x = 0; x < this->m_iWidth; x++) {
+					size_t uiCell = this->Cell(x, y);
+					if ((this->m_vCosts[uiCell] == ENT_FLOW_UNREACHED) || (this->m_vCosts[uiCell] == 0))
+						continue;
+
+					unsigned int uiBest = this->m_vCosts[uiCell];
+					for (int i = 0; i < 8; i++) {
+						if (!this->IsPassable(x, y, i))
+							continue;
+
+						const int* pOffset = NeighbourOffset(i);
+						unsigned int uiCost = this->m_vCosts[this->Cell(x + pOffset[0], y + pOffset[1])];
+						if (uiCost < uiBest) {
+							uiBest = uiCost;
+							this->m_vDirections[uiCell] = (signed char)i;
+						}
+					}
+				}
+			}
+
+			this->m_bBuilt = true;
 		}
-		size_t GetEntityId(asIScriptObject* pEntity)
+
+		bool Direction(const Vector& vPosition, int& iDirX, int& iDirY) const
 		{
-			for (size_t i = 0; i < this->m_vEnts.size(); i++) {
-				if (this->m_vEnts[i]->Object() == pEntity)
-					return true;
-			}
+			//Get the neighbour cell offset to head to from the given position. Fails in the goal cell and outside of the field
+
+			int x = CellCoord(vPosition[0]);
+			int y = CellCoord(vPosition[1]);
+			if ((!this->m_bBuilt) || (!this->IsInside(x, y)) || (this->m_vDirections[this->Cell(x, y)] < 0))
+				return false;
+
+			const int* pOffset = NeighbourOffset(this->m_vDirections[this->Cell(x, y)]);
+			iDirX = pOffset[0];
+			iDirY = pOffset[1];
 
-			return (size_t)-1;
+			return true;
 		}
-	};
 
-	extern CScriptedEntsMgr oScriptedEntMgr;
+		//Getters
+		inline const Vector& Goal(void) const { return this->m_vGoal; }
+		inline bool IsBuilt(void) const { return this->m_bBuilt; }
+	};
 
-	class CEntityTrace { //Entity tracing utility class
+	/* Group move orders. One flow field is set up per order and shared by all units of it. It is built when a unit first asks for a direction */
+	#define ENT_MOVE_ORDER_FIELDS 8
+	#define ENT_FORMATION_MIN_SPACING 32
+	class CMoveOrderMgr {
 	private:
-		struct tracedata_s {
-			Vector vStart;
-			Vector vEnd;
-			asIScriptObject* pIgnoreEnt;
+		struct unit_order_s {
+			size_t uiField;
+			unsigned int uiOrderId;
+			Vector vTarget;
 		};
 
-		std::vector<CScriptedEntity*> m_vEntities;
-		tracedata_s m_sTraceData;
-
-		void IncreaseVec(Vector& vVector)
-		{
-			//Increase vector value to move to the next position in direction to the end position
-			
-			if (vVector[0] != this->m_sTraceData.vEnd[0]) { (this->m_sTraceData.vEnd[0] - vVector[0] > 0) ? vVector[0]++ : vVector[0]--; }
-			if (vVector[1] != this->m_sTraceData.vEnd[1]) { (this->m_sTraceData.vEnd[1] - vVector[1] > 0) ? vVector[1]++ : vVector[1]--; }
-		}
+		CFlowField m_aFields[ENT_MOVE_ORDER_FIELDS];
+		unsigned int m_auiFieldOrderIds[ENT_MOVE_ORDER_FIELDS];
+		size_t m_uiNextField;
+		unsigned int m_uiNextOrderId;
+		std::unordered_map<EntityHandle, unit_order_s> m_mUnits;
+		std::vector<std::pair<std::pair<int, int>, size_t>> m_vSortedUnits;
 
-		bool EndReached(const Vector& vCurPos)
+		void RemoveStaleUnits(void)
 		{
-			//Indicate whether end has been reached
+			//Forget units which are not valid anymore
 
-			return (vCurPos[0] == this->m_sTraceData.vEnd[0]) && (vCurPos[1] == this->m_sTraceData.vEnd[1]);
+			for (std::unordered_map<EntityHandle, unit_order_s>::iterator it = this->m_mUnits.begin(); it != this->m_mUnits.end(); ) {
+				if (!oScriptedEntMgr.IsValidHandle(it->first))
+					it = this->m_mUnits.erase(it);
+				else
+					++it;
+			}
 		}
 
-		void EnumerateEntitiesAtPosition(const Vector& vPosition, asIScriptObject* pIgnoreEnt)
+		void BuildField(CFlowField& rField)
 		{
-			//Create a list with all entities at the given position
+			//Block cells of immovable entities with a model and calculate the directions
 
-			//Clear list
-			this->m_vEntities.clear();
+			const CEntitySnapshot& rSnapshot = oScriptedEntMgr.Snapshot();
 
-			for (size_t i = 0; i < oScriptedEntMgr.GetEntityCount(); i++) { //Loop through all entities
-				CScriptedEntity* pEntity = oScriptedEntMgr.GetEntity(i); //Get entity pointer
-				if ((pEntity) && (pEntity->Object() != pIgnoreEnt) && (pEntity->IsDamageable())) { //Use only valid damageable entities
-					//Obtain model pointer
-					CModel* pModel = pEntity->GetModel(); 
-					if (pModel) {
-						if (pModel->IsInside(pEntity->GetPosition(), vPosition)) { //Check if position is inside
-							//Add to list
-							this->m_vEntities.push_back(pEntity);
-						}
-					}
-				}
+			for (size_t i = 0; i < rSnapshot.Count(); i++) {
+				if ((rSnapshot.Model(i)) && (!rSnapshot.Movable(i)))
+					rField.Block(rSnapshot.BoundsMin(i), rSnapshot.BoundsMax(i));
 			}
+
+			rField.Build();
 		}
 	public:
-		CEntityTrace() {}
-		CEntityTrace(const Vector& vStart, const Vector& vEnd, asIScriptObject* pIgnoreEnt)
+		CMoveOrderMgr() : m_uiNextField(0), m_uiNextOrderId(1) { memset(this->m_auiFieldOrderIds, 0x00, sizeof(this->m_auiFieldOrderIds)); }
+		~CMoveOrderMgr() {}
+
+		void IssueMoveOrder(const std::vector<EntityHandle>& vUnits, const Vector& vGoal)
 		{
-			this->SetStart(vStart);
-			this->SetEnd(vEnd);
-			this->SetIgnoredEnt(pIgnoreEnt);
-			this->Run();
+			//Setup a flow field towards the goal, assign formation slots around it and inform each unit of its target
+
+			if (!vUnits.size())
+				return;
+
+			this->RemoveStaleUnits();
+
+			//Setup field of this order. Obstacles are added when it is built on the first query
+			size_t uiField = this->m_uiNextField;
+			this->m_uiNextField = (this->m_uiNextField + 1) % ENT_MOVE_ORDER_FIELDS;
+			unsigned int uiOrderId = this->m_uiNextOrderId++;
+			this->m_auiFieldOrderIds[uiField] = uiOrderId;
+
+			CFlowField& rField = this->m_aFields[uiField];
+			const CEntitySnapshot& rSnapshot = oScriptedEntMgr.Snapshot();
+
+			rField.Reset(pGfxReference->GetWindowWidth(), pGfxReference->GetWindowHeight(), vGoal);
+
+			//Formation is a square grid of slots around the goal, spaced by the largest selection size
+			int iColumns = (int)ceil(sqrt((double)vUnits.size()));
+			int iSpacing = (std::max)(ENT_FORMATION_MIN_SPACING, (std::max)(oScriptedEntMgr.MaxSelectionSize()[0], oScriptedEntMgr.MaxSelectionSize()[1]));
+			int iRows = ((int)vUnits.size() + iColumns - 1) / iColumns;
+
+			//Assign slots in reading order to units sorted the same way, so that paths cross less
+			this->m_vSortedUnits.clear();
+			for (size_t i = 0; i < vUnits.size(); i++) {
+				size_t uiIndex = oScriptedEntMgr.GetEntityIndex(vUnits[i]);
+				if (uiIndex == SI_INVALID_ID)
+					continue;
+
+				const Vector& vPos = rSnapshot.Position(uiIndex);
+				this->m_vSortedUnits.push_back(std::make_pair(std::make_pair(vPos[1] / iSpacing, vPos[0]), i));
+			}
+			std::sort(this->m_vSortedUnits.begin(), this->m_vSortedUnits.end());
+
+			for (size_t k = 0; k < this->m_vSortedUnits.size(); k++) {
+				EntityHandle hUnit = vUnits[this->m_vSortedUnits[k].second];
+
+				int iColumn = (int)k % iColumns;
+				int iRow = (int)k / iColumns;
+
+				unit_order_s sOrder;
+				sOrder.uiField = uiField;
+				sOrder.uiOrderId = uiOrderId;
+				sOrder.vTarget = Vector(vGoal[0] + (iColumn * 2 - (iColumns - 1)) * iSpacing / 2, vGoal[1] + (iRow * 2 - (iRows - 1)) * iSpacing / 2);
+
+				this->m_mUnits[hUnit] = sOrder;
+
+				oScriptedEntMgr.GetEntityByHandle(hUnit)->MoveTo(sOrder.vTarget);
+			}
 		}
-		~CEntityTrace() { this->m_vEntities.clear(); }
 
-		//Action
-		void Run(void)
+		bool GetDirection(EntityHandle hUnit, const Vector& vPosition, float& flAngle)
 		{
-			//Run trace computation
+			//Get steering angle of a unit at the given position. Near its target or if the field has been reused, head straight to the target.
+			//The field leads to the goal, so it is queried at the position moved by the offset of the unit's slot to the goal. That way each unit heads to its own slot
 
-			//Initialize with start position
-			Vector vCurrentPosition = this->m_sTraceData.vStart;
+			std::unordered_map<EntityHandle, unit_order_s>::const_iterator it = this->m_mUnits.find(hUnit);
+			if (it == this->m_mUnits.end())
+				return false;
 
-			while (!this->EndReached(vCurrentPosition)) { //Loop as long as end position has not yet been reached
-				//Enumerate all entities at current position
-				this->EnumerateEntitiesAtPosition(vCurrentPosition, this->m_sTraceData.pIgnoreEnt);
-				if (!this->IsEmpty()) { //Break out if at least one entity has been found
-					break;
-				}
+			const unit_order_s& rOrder = it->second;
+			CFlowField& rField = this->m_aFields[rOrder.uiField];
+			int iDirX, iDirY;
+
+			int iTargetDistX = rOrder.vTarget[0] - vPosition[0];
+			int iTargetDistY = rOrder.vTarget[1] - vPosition[1];
+			bool bNear = (abs(iTargetDistX) < ENT_FLOW_CELL_SIZE * 2) && (abs(iTargetDistY) < ENT_FLOW_CELL_SIZE * 2);
+			bool bCurrent = this->m_auiFieldOrderIds[rOrder.uiField] == rOrder.uiOrderId;
 
-				//Update current position
-				this->IncreaseVec(vCurrentPosition);
+			if ((!bNear) && (bCurrent) && (!rField.IsBuilt()))
+				this->BuildField(rField);
+
+			Vector vSlotPosition(vPosition[0] - (rOrder.vTarget[0] - rField.Goal()[0]), vPosition[1] - (rOrder.vTarget[1] - rField.Goal()[1]));
+
+			if ((!bNear) && (bCurrent) && (rField.Direction(vSlotPosition, iDirX, iDirY))) {
+				flAngle = (float)atan2((float)iDirY, (float)iDirX);
+			} else {
+				flAngle = (float)atan2((float)iTargetDistY, (float)iTargetDistX);
 			}
+
+			return true;
 		}
 
-		//Setters
-		inline void SetStart(const Vector& vVector) { this->m_sTraceData.vStart = vVector; }
-		inline void SetEnd(const Vector& vVector) { this->m_sTraceData.vEnd = vVector; }
-		inline void SetIgnoredEnt(asIScriptObject* pIgnoreEnt) { this->m_sTraceData.pIgnoreEnt = pIgnoreEnt; }
+		void Clear(void)
+		{
+			//Forget all orders
 
-		//Getters
-		inline const bool IsEmpty(void) const { return this->m_vEntities.size() == 0; }
-		inline asIScriptObject* EntityObject(const size_t uiId) { if (uiId >= this->m_vEntities.size()) return nullptr; return this->m_vEntities[uiId]->Object(); }
-		inline const size_t EntityCount(void) const { return this->m_vEntities.size(); }
+			this->m_mUnits.clear();
+		}
 	};
 
+	extern CMoveOrderMgr oMoveOrderMgr;
+
 	/* File reader class */
 	class CFileReader {
 	public:
@@ -1407,6 +3662,20 @@ namespace Entity {
 		size_t GetEntityCount();
 		asIScriptObject* GetEntityHandle(size_t uiEntityId);
 		asIScriptObject* EntityTrace(const Vector& vStart, const Vector& vEnd, asIScriptObject* pIgnoredEnt);
+		asIScriptObject* EntityTraceEx(const Vector& vStart, const Vector& vEnd, asIScriptObject* pIgnoredEnt, int& iDistance);
+		CScriptArray* QueryRadius(const Vector& vOrigin, int iRadius, bool bDamageableOnly, const std::string& szExcludeName, asIScriptObject* pIgnoredEnt);
+		CScriptArray* QueryBox(const Vector& vMin, const Vector& vMax, bool bDamageableOnly, const std::string& szExcludeName, asIScriptObject* pIgnoredEnt);
+		CScriptArray* ApplyRadialDamage(const Vector& vCenter, int iRadius, CScriptedEntity::DamageValue dvDamage, float flFalloff, const std::string& szExcludeName, bool bReturnVictims);
+		asIScriptObject* FindNearest(const Vector& vOrigin, int iMaxRange, const std::string& szExcludeName, bool bDamageableOnly);
+		void GetEntityPoolStats(pool_stats_s& out);
+		float GetInterpolationAlpha(void);
+		bool SetCollisionLayers(asIScriptObject* pEntity, asUINT uiCategory, asUINT uiMask);
+		bool GetFlowDirection(asIScriptObject* pEntity, const Vector& vPosition, float& flAngle);
+		bool SetNextThink(asIScriptObject* pEntity, asUINT uiMilliseconds);
+		bool SetLodPolicy(asIScriptObject* pEntity, bool bEnabled, asUINT uiRemoveDelay, asUINT uiProcessInterval);
+		CScriptArray* GetEntitiesByName(const std::string& szName);
+		asUINT CountByName(const std::string& szName);
+		CScriptArray* FindNearestK(const Vector& vOrigin, int iMaxRange, const std::string& szExcludeName, bool bDamageableOnly, asUINT uiCount);
 		bool Ent_IsValid(asIScriptObject* pEntity);
 		size_t Ent_GetId(asIScriptObject* pEntity);
 		bool ListSprites(const std::string& szBaseDir, asIScriptFunction* pFunction);
@@ -1420,9 +3689,23 @@ namespace Entity {
 	/* Tool component */
 	class CGameTool {
 	private:
+		enum ToolFunction { TF_INITIALIZE = 0, TF_PROCESS, TF_DRAW, TF_DRAWONTOP, TF_KEYEVENT, TF_MOUSEEVENT, TF_SELECTIONSTATUS, TF_TRIGGER, TF_RELEASE, TF_COUNT };
+
 		Scripting::HSISCRIPT m_hScript;
+		asIScriptFunction* m_apFunctions[TF_COUNT];
+
+		void ResolveFunctions(void)
+		{
+			//Resolve API functions of the tool script once
+
+			static const char* const aszNames[TF_COUNT] = { "CDG_API_Initialize", "CDG_API_Process", "CDG_API_Draw", "CDG_API_DrawOnTop", "CDG_API_KeyEvent", "CDG_API_MouseEvent", "CDG_API_SelectionStatus", "CDG_API_Trigger", "CDG_API_Release" };
+
+			for (size_t i = 0; i < TF_COUNT; i++) {
+				this->m_apFunctions[i] = pScrReference->GetScriptFunction(this->m_hScript, aszNames[i]);
+			}
+		}
 	public:
-		CGameTool(Scripting::HSISCRIPT self) : m_hScript(self) {}
+		CGameTool(Scripting::HSISCRIPT self) : m_hScript(self) { this->ResolveFunctions(); }
 		~CGameTool() {}
 
 		bool OnInitialize(void)
@@ -1433,7 +3716,7 @@ namespace Entity {
 			bool bResult = false;
 
 			//Attempt to call function
-			if (!pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_Initialize", nullptr, &bResult, Scripting::FA_BYTE)) {
+			if (!pScrReference->Call<bool>(this->m_apFunctions[TF_INITIALIZE], nullptr, &bResult)) {
 				return false;
 			}
 
@@ -1445,7 +3728,7 @@ namespace Entity {
 			//Process tool
 			//void CDG_API_Process()
 
-			pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_Process", nullptr, nullptr);
+			pScrReference->Call<void>(this->m_apFunctions[TF_PROCESS], nullptr, nullptr);
 		}
 
 		void OnDraw(void)
@@ -1453,7 +3736,7 @@ namespace Entity {
 			//Let tool draw its stuff
 			//void CDG_API_Draw()
 
-			pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_Draw", nullptr, nullptr);
+			pScrReference->Call<void>(this->m_apFunctions[TF_DRAW], nullptr, nullptr);
 		}
 
 		void OnDrawOnTop(void)
@@ -1461,7 +3744,7 @@ namespace Entity {
 			//Let tool draw its stuff on top
 			//void CDG_API_DrawOnTop()
 
-			pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_DrawOnTop", nullptr, nullptr);
+			pScrReference->Call<void>(this->m_apFunctions[TF_DRAWONTOP], nullptr, nullptr);
 		}
 
 		void OnKeyEvent(int iKey, bool bDown)
@@ -1469,19 +3752,7 @@ namespace Entity {
 			//Inform of key event
 			//void CDG_API_KeyEvent(int iKey, bool bDown)
 
-			//Setup call stack
-			BEGIN_PARAMS(vArgs);
-			PUSH_DWORD(iKey);
-			PUSH_BOOL(bDown);
-
-			//Attempt to call function
-			if (!pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_KeyEvent", &vArgs, NULL)) {
-				END_PARAMS(vArgs);
-				return;
-			}
-
-			//Clear list
-			END_PARAMS(vArgs);
+			pScrReference->Call<void>(this->m_apFunctions[TF_KEYEVENT], nullptr, nullptr, iKey, bDown);
 		}
 
 		void OnMouseEvent(const Vector& vCoords, int iKey, bool bDown)
@@ -1489,20 +3760,7 @@ namespace Entity {
 			//Inform of mouse event
 			//void CDG_API_MouseEvent(const Vector in& coords, int iKey, bool bDown)
 
-			//Setup call stack
-			BEGIN_PARAMS(vArgs);
-			PUSH_OBJECT((void*)&vCoords);
-			PUSH_DWORD(iKey);
-			PUSH_BOOL(bDown);
-
-			//Attempt to call function
-			if (!pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_MouseEvent", &vArgs, NULL)) {
-				END_PARAMS(vArgs);
-				return;
-			}
-
-			//Clear list
-			END_PARAMS(vArgs);
+			pScrReference->Call<void>(this->m_apFunctions[TF_MOUSEEVENT], nullptr, nullptr, &vCoords, iKey, bDown);
 		}
 
 		void OnSelect(bool bSelectionStatus)
@@ -1510,18 +3768,7 @@ namespace Entity {
 			//Inform of selection status
 			//void CDG_API_SelectionStatus(bool bSelectionStatus)
 
-			//Setup call stack
-			BEGIN_PARAMS(vArgs);
-			PUSH_BOOL(bSelectionStatus);
-
-			//Attempt to call function
-			if (!pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_SelectionStatus", &vArgs, NULL)) {
-				END_PARAMS(vArgs);
-				return;
-			}
-
-			//Clear list
-			END_PARAMS(vArgs);
+			pScrReference->Call<void>(this->m_apFunctions[TF_SELECTIONSTATUS], nullptr, nullptr, bSelectionStatus);
 		}
 
 		void OnTrigger(const Vector &vAtPos)
@@ -1531,14 +3778,7 @@ namespace Entity {
 
 			Vector v(vAtPos);
 
-			//Setup call stack
-			BEGIN_PARAMS(vArgs);
-			PUSH_OBJECT(&v);
-
-			pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_Trigger", &vArgs, nullptr);
-
-			//Clear list
-			END_PARAMS(vArgs);
+			pScrReference->Call<void>(this->m_apFunctions[TF_TRIGGER], nullptr, nullptr, &v);
 		}
 
 		void OnRelease(void)
@@ -1546,13 +3786,15 @@ namespace Entity {
 			//Let tool release its resources
 			//void CDG_API_Release()
 
-			pScrReference->CallScriptFunction(this->m_hScript, true, "CDG_API_Release", nullptr, nullptr);
+			pScrReference->Call<void>(this->m_apFunctions[TF_RELEASE], nullptr, nullptr);
 		}
 
 		bool IsReady(void) const { return this->m_hScript != SI_INVALID_ID; }
 	};
 
 	/* Tool manager component */
+	#define ENT_TOOL_MANIFEST_FILE "toolmanifest.txt"
+	#define ENT_TOOL_MANIFEST_HEADER "#dnyCasualDeskGame tool manifest 1"
 	class CToolMgr {
 	public:
 		typedef size_t HTOOL;
@@ -1580,14 +3822,27 @@ namespace Entity {
 			std::string szPath;
 			std::string szScript;
 			std::string szToolScript;
+			bool bFailed;
+			bool bPreviewQueried;
 		};
 	private:
+		struct tool_manifest_entry_s {
+			unsigned long long ullWriteTime;
+			unsigned long long ullFileSize;
+			ToolInfo sInfo;
+		};
+
 		std::vector<gt_list_item_s> m_vTools;
+		std::unordered_map<std::string, tool_manifest_entry_s> m_mManifest;
+		bool m_bManifestLoaded;
+		bool m_bManifestDirty;
+		game_keys_s m_sGameKeys;
 		HTOOL m_hSelectedTool;
 		Vector m_vMousePos;
 		Vector m_vStartSelPos;
 		Vector m_vEndSelPos;
-		std::vector<CScriptedEntity*> m_vSelectedEntities;
+		std::vector<EntityHandle> m_vSelectedEntities;
+		std::vector<size_t> m_vSelCandidates;
 		bool m_bSurpressSelToolForwarding;
 		DxRenderer::HD3DSPRITE m_hGotoCursor;
 		DxRenderer::HD3DSPRITE m_hPointer;
@@ -1624,59 +3879,163 @@ namespace Entity {
 			return bResult;
 		}
 
-		HTOOL LoadTool(const std::wstring& wszAbsoluteToolScript, const game_keys_s &gamekeys)
+		bool GetFileStamp(const std::string& szFile, unsigned long long& ullWriteTime, unsigned long long& ullFileSize)
 		{
-			//Load tool from script
+			//Get last write time and size of a file
 
-			if (!wszAbsoluteToolScript.length())
-				return InvalidToolHandle;
+			WIN32_FILE_ATTRIBUTE_DATA sAttributes;
+			if (!GetFileAttributesExA(szFile.c_str(), GetFileExInfoStandard, &sAttributes))
+				return false;
 
-			gt_list_item_s sToolInfo;
-			sToolInfo.szScript = Utils::ConvertToAnsiString(wszAbsoluteToolScript);
-			sToolInfo.szPath = Utils::ConvertToAnsiString(Utils::ExtractFilePath(wszAbsoluteToolScript));
-			sToolInfo.szToolScript = Utils::ConvertToAnsiString(Utils::ExtractFileName(wszAbsoluteToolScript));
-			sToolInfo.vCursorOffset.Zero();
-			sToolInfo.fCursorRotation = 0.0f;
+			ullWriteTime = ((unsigned long long)sAttributes.ftLastWriteTime.dwHighDateTime << 32) | sAttributes.ftLastWriteTime.dwLowDateTime;
+			ullFileSize = ((unsigned long long)sAttributes.nFileSizeHigh << 32) | sAttributes.nFileSizeLow;
+
+			return true;
+		}
+
+		void LoadManifest(void)
+		{
+			//Load cached tool infos. Each line holds the script, its file stamp and the tool info separated by tabs
+
+			this->m_bManifestLoaded = true;
+
+			std::ifstream hFile;
+			hFile.open(Utils::ConvertToAnsiString(wszBasePath) + ENT_TOOL_MANIFEST_FILE, std::ifstream::in);
+			if (!hFile.is_open())
+				return;
+
+			std::string szLine;
+			if ((!std::getline(hFile, szLine)) || (szLine != ENT_TOOL_MANIFEST_HEADER))
+				return;
+
+			while (std::getline(hFile, szLine)) {
+				std::vector<std::string> vFields;
+				size_t uiStart = 0;
+				size_t uiTab;
+
+				while ((uiTab = szLine.find('\t', uiStart)) != std::string::npos) {
+					vFields.push_back(szLine.substr(uiStart, uiTab - uiStart));
+					uiStart = uiTab + 1;
+				}
+				vFields.push_back(szLine.substr(uiStart));
+
+				if (vFields.size() != 13)
+					continue;
+
+				tool_manifest_entry_s sEntry;
+				sEntry.ullWriteTime = std::strtoull(vFields[1].c_str(), nullptr, 10);
+				sEntry.ullFileSize = std::strtoull(vFields[2].c_str(), nullptr, 10);
+				sEntry.sInfo.szName = vFields[3];
+				sEntry.sInfo.szVersion = vFields[4];
+				sEntry.sInfo.szAuthor = vFields[5];
+				sEntry.sInfo.szContact = vFields[6];
+				sEntry.sInfo.szPreviewImage = vFields[7];
+				sEntry.sInfo.szCursor = vFields[8];
+				sEntry.sInfo.szCategory = vFields[9];
+				sEntry.sInfo.iCursorWidth = std::atoi(vFields[10].c_str());
+				sEntry.sInfo.iCursorHeight = std::atoi(vFields[11].c_str());
+				sEntry.sInfo.uiTriggerDelay = (DWORD)std::strtoul(vFields[12].c_str(), nullptr, 10);
+
+				this->m_mManifest[vFields[0]] = sEntry;
+			}
+		}
+
+		bool CompileTool(gt_list_item_s& rTool)
+		{
+			//Compile tool script, query its info and initialize it
 
 			//Execute script
-			sToolInfo.hScript = pScrReference->LoadScript(Utils::ConvertToAnsiString(wszAbsoluteToolScript));
-			if (sToolInfo.hScript == SI_INVALID_ID)
-				return InvalidToolHandle;
+			rTool.hScript = pScrReference->LoadScript(rTool.szScript);
+			if (rTool.hScript == SI_INVALID_ID)
+				return false;
 
 			//Query tool info
-			if (!this->QueryToolInfo(sToolInfo, gamekeys)) {
-				pScrReference->UnloadScript(sToolInfo.hScript);
-				return InvalidToolHandle;
+			if (!this->QueryToolInfo(rTool, this->m_sGameKeys)) {
+				pScrReference->UnloadScript(rTool.hScript);
+				rTool.hScript = SI_INVALID_ID;
+				return false;
 			}
 
 			//Allocate tool instance
-			sToolInfo.pGameTool = new CGameTool(sToolInfo.hScript);
-			if (!sToolInfo.pGameTool) {
-				pScrReference->UnloadScript(sToolInfo.hScript);
-				return InvalidToolHandle;
-			}
-
-			//Load preview image
-			sToolInfo.hPreviewImg = pGfxReference->LoadSprite(Utils::ExtractFilePath(wszAbsoluteToolScript) + Utils::ConvertToWideString(sToolInfo.sInfo.szPreviewImage), 1, 195, 90, 1, true);
-			if (sToolInfo.hPreviewImg == GFX_INVALID_SPRITE_ID) {
-				pScrReference->UnloadScript(sToolInfo.hScript);
-				return InvalidToolHandle;
+			CGameTool* pGameTool = new CGameTool(rTool.hScript);
+			if (!pGameTool) {
+				pScrReference->UnloadScript(rTool.hScript);
+				rTool.hScript = SI_INVALID_ID;
+				return false;
 			}
 
 			//Load cursor image
-			sToolInfo.hCursor = pGfxReference->LoadSprite(Utils::ExtractFilePath(wszAbsoluteToolScript) + Utils::ConvertToWideString(sToolInfo.sInfo.szCursor), 1, sToolInfo.sInfo.iCursorWidth, sToolInfo.sInfo.iCursorHeight, 1, true);
-			if (sToolInfo.hCursor == GFX_INVALID_SPRITE_ID) {
-				pGfxReference->FreeSprite(sToolInfo.hPreviewImg);
-				pScrReference->UnloadScript(sToolInfo.hScript);
-				return InvalidToolHandle;
+			rTool.hCursor = pGfxReference->LoadSprite(Utils::ConvertToWideString(rTool.szPath + rTool.sInfo.szCursor), 1, rTool.sInfo.iCursorWidth, rTool.sInfo.iCursorHeight, 1, true);
+			if (rTool.hCursor == GFX_INVALID_SPRITE_ID) {
+				delete pGameTool;
+				pScrReference->UnloadScript(rTool.hScript);
+				rTool.hScript = SI_INVALID_ID;
+				return false;
 			}
 
 			//Inform tool of initialization
-			if (!sToolInfo.pGameTool->OnInitialize()) {
-				delete sToolInfo.pGameTool;
-				pGfxReference->FreeSprite(sToolInfo.hPreviewImg);
-				pGfxReference->FreeSprite(sToolInfo.hCursor);
+			if (!pGameTool->OnInitialize()) {
+				delete pGameTool;
+				pGfxReference->FreeSprite(rTool.hCursor);
+				rTool.hCursor = GFX_INVALID_SPRITE_ID;
+				pScrReference->UnloadScript(rTool.hScript);
+				rTool.hScript = SI_INVALID_ID;
+				return false;
+			}
+
+			rTool.pGameTool = pGameTool;
+
+			//Set trigger timer data
+			rTool.oTriggerTimer.SetDelay(rTool.sInfo.uiTriggerDelay);
+
+			return true;
+		}
+
+		HTOOL LoadTool(const std::wstring& wszAbsoluteToolScript, const game_keys_s &gamekeys)
+		{
+			//Add tool from script. If the manifest holds the info of an unchanged script, compiling is deferred until the tool is first used
+
+			if (!wszAbsoluteToolScript.length())
 				return InvalidToolHandle;
+
+			if (!this->m_bManifestLoaded)
+				this->LoadManifest();
+
+			this->m_sGameKeys = gamekeys;
+
+			gt_list_item_s sToolInfo;
+			sToolInfo.pGameTool = nullptr;
+			sToolInfo.hScript = SI_INVALID_ID;
+			sToolInfo.hPreviewImg = GFX_INVALID_SPRITE_ID;
+			sToolInfo.hCursor = GFX_INVALID_SPRITE_ID;
+			sToolInfo.szScript = Utils::ConvertToAnsiString(wszAbsoluteToolScript);
+			sToolInfo.szPath = Utils::ConvertToAnsiString(Utils::ExtractFilePath(wszAbsoluteToolScript));
+			sToolInfo.szToolScript = Utils::ConvertToAnsiString(Utils::ExtractFileName(wszAbsoluteToolScript));
+			sToolInfo.vCursorOffset.Zero();
+			sToolInfo.fCursorRotation = 0.0f;
+			sToolInfo.bFailed = false;
+			sToolInfo.bPreviewQueried = false;
+
+			unsigned long long ullWriteTime = 0, ullFileSize = 0;
+			bool bHasStamp = this->GetFileStamp(sToolInfo.szScript, ullWriteTime, ullFileSize);
+
+			std::unordered_map<std::string, tool_manifest_entry_s>::const_iterator it = this->m_mManifest.find(sToolInfo.szScript);
+			if ((bHasStamp) && (it != this->m_mManifest.end()) && (it->second.ullWriteTime == ullWriteTime) && (it->second.ullFileSize == ullFileSize)) {
+				sToolInfo.sInfo = it->second.sInfo;
+			} else {
+				//Unknown or changed tool, compile it now to get its info
+				if (!this->CompileTool(sToolInfo))
+					return InvalidToolHandle;
+
+				if (bHasStamp) {
+					tool_manifest_entry_s sEntry;
+					sEntry.ullWriteTime = ullWriteTime;
+					sEntry.ullFileSize = ullFileSize;
+					sEntry.sInfo = sToolInfo.sInfo;
+
+					this->m_mManifest[sToolInfo.szScript] = sEntry;
+					this->m_bManifestDirty = true;
+				}
 			}
 
 			//Set trigger timer data
@@ -1696,11 +4055,18 @@ namespace Entity {
 
 			//Free all tools
 			for (size_t i = 0; i < this->m_vTools.size(); i++) {
+				//Free preview which is loaded when first shown
+				if (this->m_vTools[i].hPreviewImg != GFX_INVALID_SPRITE_ID)
+					pGfxReference->FreeSprite(this->m_vTools[i].hPreviewImg);
+
+				//Tools that have never been used are not compiled
+				if (!this->m_vTools[i].pGameTool)
+					continue;
+
 				//Inform of unload event
 				this->m_vTools[i].pGameTool->OnRelease();
 
 				//Free sprites
-				pGfxReference->FreeSprite(this->m_vTools[i].hPreviewImg);
 				pGfxReference->FreeSprite(this->m_vTools[i].hCursor);
 
 				//Free object memory
@@ -1714,16 +4080,20 @@ namespace Entity {
 			this->m_vTools.clear();
 
 			//Free sprites
-			pGfxReference->FreeSprite(this->m_hGotoCursor);
-			pGfxReference->FreeSprite(this->m_hPointer);
+			if (pGfxReference) {
+				pGfxReference->FreeSprite(this->m_hGotoCursor);
+				pGfxReference->FreeSprite(this->m_hPointer);
+			}
 		}
 	public:
-		CToolMgr() : m_hSelectedTool(InvalidToolHandle), m_bSurpressSelToolForwarding(false), m_bDrawPointer(false), m_bCtrlHeld(false), m_bInSelection(false), m_bReleaseButtonNext(false)
+		CToolMgr() : m_bManifestLoaded(false), m_bManifestDirty(false), m_hSelectedTool(InvalidToolHandle), m_bSurpressSelToolForwarding(false), m_bDrawPointer(false), m_bCtrlHeld(false), m_bInSelection(false), m_bReleaseButtonNext(false)
 		{ 
 			_pGameToolMgrInstance = this;
 
-			this->m_hGotoCursor = pGfxReference->LoadSprite(L"res\\gotocursor.png", 1, 32, 32, 1, false);
-			this->m_hPointer = pGfxReference->LoadSprite(L"res\\pointer.png", 1, 72, 72, 1, false);
+			memset(&this->m_sGameKeys, 0x00, sizeof(this->m_sGameKeys));
+
+			this->m_hGotoCursor = (pGfxReference) ? pGfxReference->LoadSprite(L"res\\gotocursor.png", 1, 32, 32, 1, false) : GFX_INVALID_SPRITE_ID;
+			this->m_hPointer = (pGfxReference) ? pGfxReference->LoadSprite(L"res\\pointer.png", 1, 72, 72, 1, false) : GFX_INVALID_SPRITE_ID;
 		}
 		~CToolMgr() { this->Release(); }
 
@@ -1742,13 +4112,90 @@ namespace Entity {
 			return this->LoadTool(wszToolPath, gamekeys);
 		}
 
+		bool SaveManifest(void)
+		{
+			//Store tool infos for the next start if tools have been compiled for their info or tools have been removed
+
+			for (std::unordered_map<std::string, tool_manifest_entry_s>::iterator it = this->m_mManifest.begin(); it != this->m_mManifest.end(); ) {
+				unsigned long long ullWriteTime, ullFileSize;
+
+				//Drop entries of tools whose script or directory has been deleted
+				if (!this->GetFileStamp(it->first, ullWriteTime, ullFileSize)) {
+					it = this->m_mManifest.erase(it);
+					this->m_bManifestDirty = true;
+				} else {
+					++it;
+				}
+			}
+
+			if (!this->m_bManifestDirty)
+				return true;
+
+			std::ofstream hFile;
+			hFile.open(Utils::ConvertToAnsiString(wszBasePath) + ENT_TOOL_MANIFEST_FILE, std::ofstream::out | std::ofstream::trunc);
+			if (!hFile.is_open())
+				return false;
+
+			hFile << ENT_TOOL_MANIFEST_HEADER << std::endl;
+
+			for (std::unordered_map<std::string, tool_manifest_entry_s>::const_iterator it = this->m_mManifest.begin(); it != this->m_mManifest.end(); ++it) {
+				const ToolInfo& rInfo = it->second.sInfo;
+				std::string szText = it->first + rInfo.szName + rInfo.szVersion + rInfo.szAuthor + rInfo.szContact + rInfo.szPreviewImage + rInfo.szCursor + rInfo.szCategory;
+
+				//Entries that would break the line format are compiled on every start instead
+				if (szText.find_first_of("\t\r\n") != std::string::npos)
+					continue;
+
+				hFile << it->first << '\t' << it->second.ullWriteTime << '\t' << it->second.ullFileSize << '\t' << rInfo.szName << '\t' << rInfo.szVersion << '\t' << rInfo.szAuthor << '\t' << rInfo.szContact << '\t'
+					<< rInfo.szPreviewImage << '\t' << rInfo.szCursor << '\t' << rInfo.szCategory << '\t' << rInfo.iCursorWidth << '\t' << rInfo.iCursorHeight << '\t' << rInfo.uiTriggerDelay << std::endl;
+			}
+
+			this->m_bManifestDirty = false;
+
+			return true;
+		}
+
+		bool Activate(HTOOL hTool)
+		{
+			//Compile and initialize tool when it is used for the first time
+
+			if (hTool >= this->m_vTools.size())
+				return false;
+
+			gt_list_item_s& rTool = this->m_vTools[hTool];
+			if (rTool.pGameTool)
+				return true;
+
+			//Do not retry tools that failed once
+			if (rTool.bFailed)
+				return false;
+
+			rTool.bFailed = !this->CompileTool(rTool);
+
+			return !rTool.bFailed;
+		}
+
+		bool Activate(const std::wstring& wszName)
+		{
+			//Activate tool (by name)
+
+			for (size_t i = 0; i < this->m_vTools.size(); i++) {
+				if (this->m_vTools[i].szToolScript == Utils::ConvertToAnsiString(wszName)) {
+					return this->Activate(i);
+				}
+			}
+
+			return false;
+		}
+
 		void Process(void)
 		{
 			//Process stuff
 
 			//Inform tools
 			for (size_t i = 0; i < this->m_vTools.size(); i++) {
-				this->m_vTools[i].pGameTool->OnProcess();
+				if (this->m_vTools[i].pGameTool)
+					this->m_vTools[i].pGameTool->OnProcess();
 			}
 
 			//Inform scripted entities
@@ -1779,7 +4226,8 @@ namespace Entity {
 
 			//Inform tools
 			for (size_t i = 0; i < this->m_vTools.size(); i++) {
-				this->m_vTools[i].pGameTool->OnDraw();
+				if (this->m_vTools[i].pGameTool)
+					this->m_vTools[i].pGameTool->OnDraw();
 			}
 
 			//Inform scripted entities
@@ -1792,7 +4240,8 @@ namespace Entity {
 
 			//Inform tools
 			for (size_t i = 0; i < this->m_vTools.size(); i++) {
-				this->m_vTools[i].pGameTool->OnDrawOnTop();
+				if (this->m_vTools[i].pGameTool)
+					this->m_vTools[i].pGameTool->OnDrawOnTop();
 			}
 
 			//Inform scripted entities
@@ -1863,9 +4312,13 @@ namespace Entity {
 			}
 
 			//Clear if not valid anymore
-			for (size_t i = 0; i < this->m_vSelectedEntities.size(); i++) {
-				if ((this->m_vSelectedEntities[i] != nullptr) && (!oScriptedEntMgr.IsValidEntity(this->m_vSelectedEntities[i]->Object()))) {
-					this->m_vSelectedEntities.erase(this->m_vSelectedEntities.begin() + i);
+			for (size_t i = 0; i < this->m_vSelectedEntities.size(); ) {
+				if (!oScriptedEntMgr.IsValidHandle(this->m_vSelectedEntities[i])) {
+					//Selection order is irrelevant, so replace with the last one
+					this->m_vSelectedEntities[i] = this->m_vSelectedEntities.back();
+					this->m_vSelectedEntities.pop_back();
+				} else {
+					i++;
 				}
 			}
 
@@ -1882,27 +4335,35 @@ namespace Entity {
 				this->m_vEndSelPos[0] = this->m_vMousePos[0];
 				this->m_vEndSelPos[1] = this->m_vMousePos[1];
 
+				CScriptedEntsMgr::query_filter_s sFilter = oScriptedEntMgr.MakeFilter(false, "", nullptr);
+				sFilter.bMovableOnly = true;
+
 				if ((this->m_vEndSelPos[0] != this->m_vStartSelPos[0]) && (this->m_vEndSelPos[1] != this->m_vStartSelPos[1])) {
-					for (size_t i = 0; i < oScriptedEntMgr.GetEntityCount(); i++) {
+					//Entities must be positioned strictly inside the selection rectangle
+					oScriptedEntMgr.QueryBox(Vector(this->m_vStartSelPos[0] + 1, this->m_vStartSelPos[1] + 1), Vector(this->m_vEndSelPos[0] - 1, this->m_vEndSelPos[1] - 1), sFilter, this->m_vSelCandidates);
+
+					for (size_t k = 0; k < this->m_vSelCandidates.size(); k++) {
+						size_t i = this->m_vSelCandidates[k];
 						CScriptedEntity* pEntity = oScriptedEntMgr.GetEntity(i);
-						if ((pEntity != nullptr) && (pEntity->IsMovable()) && (oScriptedEntMgr.IsValidEntity(pEntity->Object()))) {
-							Vector vCurPos = pEntity->GetPosition();
-							Vector vSelSize = pEntity->GetSelectionSize();
-							if ((vCurPos[0] > this->m_vStartSelPos[0]) && (vCurPos[0] - vSelSize[0] / 2 + vSelSize[0] < this->m_vEndSelPos[0]) && (vCurPos[1] > this->m_vStartSelPos[1]) && (vCurPos[1] - vSelSize[1] / 2 + vSelSize[1] < this->m_vEndSelPos[1])) {
-								this->m_vSelectedEntities.push_back(pEntity);
-							}
+						Vector vCurPos = oScriptedEntMgr.Snapshot().Position(i);
+						const Vector& vSelSize = pEntity->SelectionSize();
+						if ((vCurPos[0] > this->m_vStartSelPos[0]) && (vCurPos[0] - vSelSize[0] / 2 + vSelSize[0] < this->m_vEndSelPos[0]) && (vCurPos[1] > this->m_vStartSelPos[1]) && (vCurPos[1] - vSelSize[1] / 2 + vSelSize[1] < this->m_vEndSelPos[1])) {
+							this->m_vSelectedEntities.push_back(pEntity->Handle());
 						}
 					}
 				}
 				else {
-					for (size_t i = 0; i < oScriptedEntMgr.GetEntityCount(); i++) {
+					//Entities can only be hit if positioned within the largest selection size around the click
+					const Vector& vMaxSize = oScriptedEntMgr.MaxSelectionSize();
+					oScriptedEntMgr.QueryBox(Vector(this->m_vEndSelPos[0] - vMaxSize[0], this->m_vEndSelPos[1] - vMaxSize[1]), Vector(this->m_vStartSelPos[0] + vMaxSize[0], this->m_vStartSelPos[1] + vMaxSize[1]), sFilter, this->m_vSelCandidates);
+
+					for (size_t k = 0; k < this->m_vSelCandidates.size(); k++) {
+						size_t i = this->m_vSelCandidates[k];
 						CScriptedEntity* pEntity = oScriptedEntMgr.GetEntity(i);
-						if ((pEntity != nullptr) && (pEntity->IsMovable()) && (oScriptedEntMgr.IsValidEntity(pEntity->Object()))) {
-							Vector vCurPos = pEntity->GetPosition();
-							Vector vSelSize = pEntity->GetSelectionSize();
-							if ((this->m_vStartSelPos[0] > vCurPos[0] - vSelSize[0] / 2) && (this->m_vEndSelPos[0] < vCurPos[0] - vSelSize[0] / 2 + vSelSize[0]) && (this->m_vStartSelPos[1] > vCurPos[1] - vSelSize[1] / 2) && (this->m_vEndSelPos[1] < vCurPos[1] - vSelSize[1] / 2 + vSelSize[1])) {
-								this->m_vSelectedEntities.push_back(pEntity);
-							}
+						Vector vCurPos = oScriptedEntMgr.Snapshot().Position(i);
+						const Vector& vSelSize = pEntity->SelectionSize();
+						if ((this->m_vStartSelPos[0] > vCurPos[0] - vSelSize[0] / 2) && (this->m_vEndSelPos[0] < vCurPos[0] - vSelSize[0] / 2 + vSelSize[0]) && (this->m_vStartSelPos[1] > vCurPos[1] - vSelSize[1] / 2) && (this->m_vEndSelPos[1] < vCurPos[1] - vSelSize[1] / 2 + vSelSize[1])) {
+							this->m_vSelectedEntities.push_back(pEntity->Handle());
 						}
 					}
 				}
@@ -1911,11 +4372,7 @@ namespace Entity {
 			//Process movement command
 			if ((iKey == gamekeys.vkTrigger) && (!bCtrlHeld)) {
 				if (this->m_bSurpressSelToolForwarding) {
-					for (size_t i = 0; i < this->m_vSelectedEntities.size(); i++) {
-						if (this->m_vSelectedEntities[i] != nullptr) {
-							this->m_vSelectedEntities[i]->MoveTo(this->m_vMousePos);
-						}
-					}
+					oMoveOrderMgr.IssueMoveOrder(this->m_vSelectedEntities, this->m_vMousePos);
 
 					this->m_vSelectedEntities.clear();
 
@@ -1940,7 +4397,8 @@ namespace Entity {
 		{
 			//Select tool (by handle)
 
-			if (hTool >= this->m_vTools.size())
+			//Compile tool on first selection
+			if (!this->Activate(hTool))
 				return false;
 
 			//Inform previous selected tool 
@@ -1992,7 +4450,21 @@ namespace Entity {
 		size_t Count(void) { return this->m_vTools.size(); }
 		const gt_list_item_s& GetBaseInfo(const HTOOL hTool) { static gt_list_item_s sEmpty; if (hTool >= this->m_vTools.size()) return sEmpty; return this->m_vTools[hTool]; }
 		const ToolInfo& GetInfo(const HTOOL hTool) { if (hTool >= this->m_vTools.size()) return ToolInfo(); return this->m_vTools[hTool].sInfo; }
-		DxRenderer::HD3DSPRITE GetPreviewImage(const HTOOL hTool) { if (hTool >= this->m_vTools.size()) return GFX_INVALID_SPRITE_ID; return this->m_vTools[hTool].hPreviewImg; }
+		DxRenderer::HD3DSPRITE GetPreviewImage(const HTOOL hTool)
+		{
+			//Get preview image, it is loaded when it is requested for the first time
+
+			if (hTool >= this->m_vTools.size())
+				return GFX_INVALID_SPRITE_ID;
+
+			gt_list_item_s& rTool = this->m_vTools[hTool];
+			if (!rTool.bPreviewQueried) {
+				rTool.bPreviewQueried = true;
+				rTool.hPreviewImg = pGfxReference->LoadSprite(Utils::ConvertToWideString(rTool.szPath + rTool.sInfo.szPreviewImage), 1, 195, 90, 1, true);
+			}
+
+			return rTool.hPreviewImg;
+		}
 		Scripting::HSISCRIPT GetScriptHandleOfTool(HTOOL hTool) { if (hTool >= this->m_vTools.size()) return SI_INVALID_ID; return this->m_vTools[hTool].hScript; }
 		Scripting::HSISCRIPT GetScriptHandleOfSelection(void) { if (this->m_hSelectedTool == InvalidToolHandle) return SI_INVALID_ID; return this->m_vTools[this->m_hSelectedTool].hScript; }
 		HTOOL FindTool(const std::wstring& wszName)
@@ -2014,11 +4486,14 @@ namespace Entity {
 			}
 			return L"";
 		}
-		const std::vector<CScriptedEntity*>& GetSelectionEntities(void) const { return this->m_vSelectedEntities; }
-		bool IsSelectionEntityValid(size_t index) { if ((index < this->m_vSelectedEntities.size()) && (this->m_vSelectedEntities[index] != nullptr)) { return oScriptedEntMgr.IsValidEntity(this->m_vSelectedEntities[index]->Object()); } else { return false;  } }
+		const std::vector<EntityHandle>& GetSelectionEntities(void) const { return this->m_vSelectedEntities; }
+		bool IsSelectionEntityValid(size_t index) { return (index < this->m_vSelectedEntities.size()) && (oScriptedEntMgr.IsValidHandle(this->m_vSelectedEntities[index])); }
 	};
 
 	CToolMgr* Initialize(DxRenderer::CDxRenderer* pGfx, DxSound::CDxSound* pSnd, Scripting::CScriptInt* pScr, Console::CConsole* pCns);
 	void DoUserCleaning(void);
 	void SetBasePath(const std::wstring& path);
+	void SetEntityBudget(size_t uiEntityCount);
+	void SetTickRate(unsigned int uiTickRate);
+	void SetInterpolationAlpha(float flAlpha);
 }
\ No newline at end of file
@@ -21,6 +21,7 @@
 #include "browser.h"
 #include "workshop.h"
 #include "logger.h"
+#include "scheduler.h"
 #include <steam_api.h>
 
 /* Game management component */
@@ -46,6 +47,10 @@ namespace Game {
 	Logger::CLogger* pLogger = nullptr;
 	Menu::WorkshopService_e eServiceType;
 	bool bEnableScreenshotUpload;
+	size_t uiEntityBudget = ENT_DEFAULT_BUDGET;
+	unsigned int uiTickRate = SCHED_DEFAULT_TICK_RATE;
+	Scheduler::CPerformanceClock oSimulationClock;
+	Scheduler::CFixedStepScheduler oSimulationScheduler;
 
 	void AS_MessageCallback(const asSMessageInfo *msg, void *param);
 	std::wstring GetToolFromBinding(const std::wstring& wszKey);
@@ -150,6 +155,41 @@ namespace Game {
 		return false;
 	}
 
+	bool LoadEngineSettings(const std::wstring& wszInputFile)
+	{
+		//Load engine configuration
+
+		std::wifstream hFile;
+		std::wstring wLine = L"1";
+		hFile.open(wszInputFile, std::wifstream::in);
+		if (hFile.is_open()) {
+			while (!hFile.eof()) {
+				std::getline(hFile, wLine);
+
+				if (wLine.find(L"entity_budget") == 0) {
+					std::wstring wszValue = wLine.substr(wLine.find(L" ") + 1);
+					int iValue = _wtoi(wszValue.c_str());
+					if (iValue > 0) {
+						Game::uiEntityBudget = (size_t)iValue;
+					}
+				}
+				else if (wLine.find(L"tick_rate") == 0) {
+					std::wstring wszValue = wLine.substr(wLine.find(L" ") + 1);
+					int iValue = _wtoi(wszValue.c_str());
+					if (iValue > 0) {
+						Game::uiTickRate = (unsigned int)iValue;
+					}
+				}
+			}
+
+			hFile.close();
+
+			return true;
+		}
+
+		return false;
+	}
+
 	bool StoreExitConfirmationIndicator(const std::wstring& wszOutputFile)
 	{
 		//Store indicator value to file
@@ -198,7 +238,15 @@ namespace Game {
 				if (pGameMenu->IsVisible()) { if (bDown) pGameMenu->ScrollDown(); }
 			}
 			else if (vKey == sGameKeys.vkConsole) {
-				if (bDown) pConsole->Toggle();
+				if (bDown) {
+					pConsole->Toggle();
+
+					if (pConsole->IsVisible()) {
+						const Entity::CScriptedEntsMgr::lod_stats_s& rLodStats = Entity::oScriptedEntMgr.LodStats();
+						pConsole->AddLine(L"Entity LOD: " + std::to_wstring(rLodStats.ullSkippedProcess) + L" process calls and " + std::to_wstring(rLodStats.ullSkippedDraw) + L" draw calls skipped, " + std::to_wstring(rLodStats.ullRemoved) + L" entities removed");
+						pConsole->AddLine(L"Script contexts: " + std::to_wstring(pScriptingInt->ContextsCreated()) + L" created, " + std::to_wstring(pScriptingInt->ContextsReused()) + L" reused");
+					}
+				}
 			}
 			else if (vKey == sGameKeys.vkTakeScreen) {
 				if (bDown) {
@@ -341,11 +389,13 @@ namespace Game {
 
 				pToolManager->DrawOnTop((!pGameMenu->IsVisible()) && (!pExitMenu->IsVisible()));
 
-				const std::vector<Entity::CScriptedEntity*> vSelEntityList = pToolManager->GetSelectionEntities();
+				//Selection boxes use the positions of the last tick, the same ones the selection has been made with
+				const std::vector<Entity::EntityHandle>& vSelEntityList = pToolManager->GetSelectionEntities();
 				for (size_t i = 0; i < vSelEntityList.size(); i++) {
-					if ((vSelEntityList[i] != nullptr) && (pToolManager->IsSelectionEntityValid(i))) {
-						Entity::Vector vecPos = vSelEntityList[i]->GetPosition();
-						Entity::Vector vecSize = vSelEntityList[i]->GetSelectionSize();
+					size_t uiEntity = Entity::oScriptedEntMgr.GetEntityIndex(vSelEntityList[i]);
+					if (uiEntity != SI_INVALID_ID) {
+						const Entity::Vector& vecPos = Entity::oScriptedEntMgr.Snapshot().Position(uiEntity);
+						const Entity::Vector& vecSize = Entity::oScriptedEntMgr.GetEntity(uiEntity)->SelectionSize();
 
 						pDxRenderer->DrawBox(vecPos[0] - 2, vecPos[1] - 2, vecSize[0] + 1, vecSize[1] + 1, 1, 200, 200, 200, 150);
 					}
@@ -690,6 +740,9 @@ namespace Game {
 
 		pLogger->Log(Logger::LOG_INFO, L"Initialized scripting interface");
 
+		//Keep compiled tool scripts across starts
+		pScriptingInt->SetByteCodeCacheDir(Utils::ConvertToAnsiString(wszBaseDirectory + L"bytecode"));
+
 		//Initialize entity environment
 		pToolManager = Entity::Initialize(pDxRenderer, pDxSound, pScriptingInt, pConsole);
 		if (!pToolManager) {
@@ -699,6 +752,23 @@ namespace Game {
 
 		pLogger->Log(Logger::LOG_INFO, L"Initialized entity environment");
 
+		//Load engine configuration
+		if (!LoadEngineSettings(L"res\\engine.txt")) {
+			pLogger->Log(Logger::LOG_WARNING, L"LoadEngineSettings() failed: " + std::to_wstring(GetLastError()));
+		}
+
+		Entity::SetEntityBudget(uiEntityBudget);
+
+		pLogger->Log(Logger::LOG_INFO, L"Entity budget: " + std::to_wstring(uiEntityBudget));
+
+		//Setup simulation scheduler
+		oSimulationScheduler.SetTickRate(uiTickRate);
+		oSimulationScheduler.SetClock(&oSimulationClock);
+		Entity::SetTickRate(uiTickRate);
+
+		pLogger->Log(Logger::LOG_INFO, L"Simulation tick rate: " + std::to_wstring(uiTickRate));
+		pLogger->Log(Logger::LOG_INFO, L"Rectangle kernels: " + Utils::ConvertToWideString(RectKernels::LevelName(RectKernels::ActiveLevel())));
+
 		//Load tool bindings
 		if (!LoadToolBindings(wszBaseDirectory + L"res\\toolbindings.txt")) {
 			pLogger->Log(Logger::LOG_ERROR, L"LoadToolBindings() failed: " + std::to_wstring(GetLastError()));
@@ -782,6 +852,11 @@ namespace Game {
 
 		pLogger->Log(Logger::LOG_INFO, L"Initialized Steam Workshop interface");
 
+		//Measure loading of Workshop and local tools
+		LARGE_INTEGER liFrequency, liLoadStart, liLoadEnd;
+		QueryPerformanceFrequency(&liFrequency);
+		QueryPerformanceCounter(&liLoadStart);
+
 		//Process subscribed Workshop items
 		if (!pSteamDownloader->ProcessSubscribedItems()) {
 			pLogger->Log(Logger::LOG_WARNING, L"Workshop::CSteamDownload::ProcessSubscribedItems() failed: " + std::to_wstring(GetLastError()));
@@ -795,7 +870,23 @@ namespace Game {
 			return false;
 		}
 
-		pLogger->Log(Logger::LOG_INFO, L"Loaded all tools");
+		//Compile tools that are bound to a key, all other tools are compiled when first selected
+		for (size_t i = 0; i < vToolBindings.size(); i++) {
+			if (vToolBindings[i].size() == 2) {
+				if (!pToolManager->Activate(vToolBindings[i][1]))
+					pLogger->Log(Logger::LOG_WARNING, L"Failed to activate bound tool: " + vToolBindings[i][1]);
+			}
+		}
+
+		//Store tool infos for the metadata pass of the next start
+		if (!pToolManager->SaveManifest()) {
+			pLogger->Log(Logger::LOG_WARNING, L"Entity::CToolMgr::SaveManifest() failed: " + std::to_wstring(GetLastError()));
+		}
+
+		QueryPerformanceCounter(&liLoadEnd);
+
+		//Cold starts compile the scripts, warm starts load them from the bytecode cache
+		pLogger->Log(Logger::LOG_INFO, L"Loaded all tools in " + std::to_wstring((liLoadEnd.QuadPart - liLoadStart.QuadPart) * 1000 / liFrequency.QuadPart) + L" ms (" + std::to_wstring(pScriptingInt->ScriptsCompiled()) + L" compiled, " + std::to_wstring(pScriptingInt->ScriptsFromCache()) + L" from bytecode cache)");
 
 		//Set background image
 		if (!pDxRenderer->SetBackgroundPicture(wszBaseDirectory + DesktopScreenshotFileName)) {
@@ -818,9 +909,19 @@ namespace Game {
 	{
 		//Process game
 
+		oSimulationScheduler.Reset();
+
 		while (bGameReady) {
 			if (pDxWindow) pDxWindow->Process();
-			if (pToolManager) pToolManager->Process();
+
+			//Run the simulation steps that are due
+			unsigned int uiSteps = oSimulationScheduler.Advance();
+			for (unsigned int i = 0; i < uiSteps; i++) {
+				if (pToolManager) pToolManager->Process();
+			}
+
+			Entity::SetInterpolationAlpha(oSimulationScheduler.Alpha());
+
 			if (pGameMenu) pGameMenu->Process();
 
 			SteamAPI_RunCallbacks();
@@ -0,0 +1,312 @@
+#include "rectkernels.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define RK_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define RK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace RectKernels {
+	typedef bool(*TpfnAnyContainsPoint)(const rect_columns_s& rRects, int x, int y);
+	typedef size_t(*TpfnCollectOverlapping)(const rect_columns_s& rRects, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut);
+	typedef size_t(*TpfnCollectContained)(const int* piPoints, size_t uiCount, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut);
+
+	struct kernel_table_s {
+		TpfnAnyContainsPoint pfnAnyContainsPoint;
+		TpfnCollectOverlapping pfnCollectOverlapping;
+		TpfnCollectContained pfnCollectContained;
+	};
+
+	/* Scalar implementation, also used for the remaining items of the vectorized ones */
+	namespace Scalar {
+		bool AnyContainsPoint(const rect_columns_s& rRects, size_t uiFirst, int x, int y)
+		{
+			for (size_t i = uiFirst; i < rRects.uiCount; i++) {
+				if ((x >= rRects.piMinX[i]) && (x <= rRects.piMaxX[i]) && (y >= rRects.piMinY[i]) && (y <= rRects.piMaxY[i]))
+					return true;
+			}
+
+			return false;
+		}
+
+		size_t CollectOverlapping(const rect_columns_s& rRects, size_t uiFirst, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut)
+		{
+			size_t uiFound = 0;
+
+			for (size_t i = uiFirst; i < rRects.uiCount; i++) {
+				if ((rRects.piMinX[i] <= iMaxX) && (iMinX <= rRects.piMaxX[i]) && (rRects.piMinY[i] <= iMaxY) && (iMinY <= rRects.piMaxY[i]))
+					puiOut[uiFound++] = i;
+			}
+
+			return uiFound;
+		}
+
+		size_t CollectContained(const int* piPoints, size_t uiFirst, size_t uiCount, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut)
+		{
+			size_t uiFound = 0;
+
+			for (size_t i = uiFirst; i < uiCount; i++) {
+				int x = piPoints[i * 2];
+				int y = piPoints[i * 2 + 1];
+
+				if ((x >= iMinX) && (x <= iMaxX) && (y >= iMinY) && (y <= iMaxY))
+					puiOut[uiFound++] = i;
+			}
+
+			return uiFound;
+		}
+
+		bool AnyContainsPoint(const rect_columns_s& rRects, int x, int y) { return AnyContainsPoint(rRects, 0, x, y); }
+		size_t CollectOverlapping(const rect_columns_s& rRects, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut) { return CollectOverlapping(rRects, 0, iMinX, iMinY, iMaxX, iMaxY, puiOut); }
+		size_t CollectContained(const int* piPoints, size_t uiCount, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut) { return CollectContained(piPoints, 0, uiCount, iMinX, iMinY, iMaxX, iMaxY, puiOut); }
+	}
+
+	/* SSE2 implementation, 4 rectangles or 2 points per step */
+	namespace Sse2 {
+		bool AnyContainsPoint(const rect_columns_s& rRects, int x, int y)
+		{
+			__m128i vX = _mm_set1_epi32(x);
+			__m128i vY = _mm_set1_epi32(y);
+
+			size_t i = 0;
+			for (; i + 4 <= rRects.uiCount; i += 4) {
+				//A lane fails if the point lies outside on any side
+				__m128i vFail = _mm_or_si128(
+					_mm_or_si128(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(rRects.piMinX + i)), vX), _mm_cmpgt_epi32(vX, _mm_loadu_si128((const __m128i*)(rRects.piMaxX + i)))),
+					_mm_or_si128(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(rRects.piMinY + i)), vY), _mm_cmpgt_epi32(vY, _mm_loadu_si128((const __m128i*)(rRects.piMaxY + i)))));
+
+				if (_mm_movemask_ps(_mm_castsi128_ps(vFail)) != 0xF)
+					return true;
+			}
+
+			return Scalar::AnyContainsPoint(rRects, i, x, y);
+		}
+
+		size_t CollectOverlapping(const rect_columns_s& rRects, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut)
+		{
+			__m128i vMinX = _mm_set1_epi32(iMinX);
+			__m128i vMinY = _mm_set1_epi32(iMinY);
+			__m128i vMaxX = _mm_set1_epi32(iMaxX);
+			__m128i vMaxY = _mm_set1_epi32(iMaxY);
+
+			size_t uiFound = 0;
+
+			size_t i = 0;
+			for (; i + 4 <= rRects.uiCount; i += 4) {
+				//A lane fails if the rectangles are separated on any side
+				__m128i vFail = _mm_or_si128(
+					_mm_or_si128(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(rRects.piMinX + i)), vMaxX), _mm_cmpgt_epi32(vMinX, _mm_loadu_si128((const __m128i*)(rRects.piMaxX + i)))),
+					_mm_or_si128(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(rRects.piMinY + i)), vMaxY), _mm_cmpgt_epi32(vMinY, _mm_loadu_si128((const __m128i*)(rRects.piMaxY + i)))));
+
+				int iHits = ~_mm_movemask_ps(_mm_castsi128_ps(vFail)) & 0xF;
+				for (size_t k = 0; iHits; k++, iHits >>= 1) {
+					if (iHits & 1)
+						puiOut[uiFound++] = i + k;
+				}
+			}
+
+			return uiFound + Scalar::CollectOverlapping(rRects, i, iMinX, iMinY, iMaxX, iMaxY, puiOut + uiFound);
+		}
+
+		size_t CollectContained(const int* piPoints, size_t uiCount, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut)
+		{
+			//Points are interleaved, so compare against interleaved bounds and require both lanes of a point to pass
+			__m128i vMin = _mm_setr_epi32(iMinX, iMinY, iMinX, iMinY);
+			__m128i vMax = _mm_setr_epi32(iMaxX, iMaxY, iMaxX, iMaxY);
+
+			size_t uiFound = 0;
+
+			size_t i = 0;
+			for (; i + 2 <= uiCount; i += 2) {
+				__m128i vPoints = _mm_loadu_si128((const __m128i*)(piPoints + i * 2));
+				__m128i vFail = _mm_or_si128(_mm_cmpgt_epi32(vMin, vPoints), _mm_cmpgt_epi32(vPoints, vMax));
+
+				int iFail = _mm_movemask_ps(_mm_castsi128_ps(vFail));
+				if (!(iFail & 0x3)) puiOut[uiFound++] = i;
+				if (!(iFail & 0xC)) puiOut[uiFound++] = i + 1;
+			}
+
+			return uiFound + Scalar::CollectContained(piPoints, i, uiCount, iMinX, iMinY, iMaxX, iMaxY, puiOut + uiFound);
+		}
+	}
+
+	/* AVX2 implementation, 8 rectangles or 4 points per step */
+	namespace Avx2 {
+		RK_TARGET_AVX2 bool AnyContainsPoint(const rect_columns_s& rRects, int x, int y)
+		{
+			__m256i vX = _mm256_set1_epi32(x);
+			__m256i vY = _mm256_set1_epi32(y);
+
+			size_t i = 0;
+			for (; i + 8 <= rRects.uiCount; i += 8) {
+				__m256i vFail = _mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(rRects.piMinX + i)), vX), _mm256_cmpgt_epi32(vX, _mm256_loadu_si256((const __m256i*)(rRects.piMaxX + i)))),
+					_mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(rRects.piMinY + i)), vY), _mm256_cmpgt_epi32(vY, _mm256_loadu_si256((const __m256i*)(rRects.piMaxY + i)))));
+
+				if (_mm256_movemask_ps(_mm256_castsi256_ps(vFail)) != 0xFF)
+					return true;
+			}
+
+			return Scalar::AnyContainsPoint(rRects, i, x, y);
+		}
+
+		RK_TARGET_AVX2 size_t CollectOverlapping(const rect_columns_s& rRects, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut)
+		{
+			__m256i vMinX = _mm256_set1_epi32(iMinX);
+			__m256i vMinY = _mm256_set1_epi32(iMinY);
+			__m256i vMaxX = _mm256_set1_epi32(iMaxX);
+			__m256i vMaxY = _mm256_set1_epi32(iMaxY);
+
+			size_t uiFound = 0;
+
+			size_t i = 0;
+			for (; i + 8 <= rRects.uiCount; i += 8) {
+				__m256i vFail = _mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(rRects.piMinX + i)), vMaxX), _mm256_cmpgt_epi32(vMinX, _mm256_loadu_si256((const __m256i*)(rRects.piMaxX + i)))),
+					_mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(rRects.piMinY + i)), vMaxY), _mm256_cmpgt_epi32(vMinY, _mm256_loadu_si256((const __m256i*)(rRects.piMaxY + i)))));
+
+				int iHits = ~_mm256_movemask_ps(_mm256_castsi256_ps(vFail)) & 0xFF;
+				for (size_t k = 0; iHits; k++, iHits >>= 1) {
+					if (iHits & 1)
+						puiOut[uiFound++] = i + k;
+				}
+			}
+
+			return uiFound + Scalar::CollectOverlapping(rRects, i, iMinX, iMinY, iMaxX, iMaxY, puiOut + uiFound);
+		}
+
+		RK_TARGET_AVX2 size_t CollectContained(const int* piPoints, size_t uiCount, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut)
+		{
+			__m256i vMin = _mm256_setr_epi32(iMinX, iMinY, iMinX, iMinY, iMinX, iMinY, iMinX, iMinY);
+			__m256i vMax = _mm256_setr_epi32(iMaxX, iMaxY, iMaxX, iMaxY, iMaxX, iMaxY, iMaxX, iMaxY);
+
+			size_t uiFound = 0;
+
+			size_t i = 0;
+			for (; i + 4 <= uiCount; i += 4) {
+				__m256i vPoints = _mm256_loadu_si256((const __m256i*)(piPoints + i * 2));
+				__m256i vFail = _mm256_or_si256(_mm256_cmpgt_epi32(vMin, vPoints), _mm256_cmpgt_epi32(vPoints, vMax));
+
+				int iFail = _mm256_movemask_ps(_mm256_castsi256_ps(vFail));
+				for (size_t k = 0; k < 4; k++) {
+					if (!((iFail >> (k * 2)) & 0x3))
+						puiOut[uiFound++] = i + k;
+				}
+			}
+
+			return uiFound + Scalar::CollectContained(piPoints, i, uiCount, iMinX, iMinY, iMaxX, iMaxY, puiOut + uiFound);
+		}
+	}
+
+	static const kernel_table_s sKernels[] = {
+		{ &Scalar::AnyContainsPoint, &Scalar::CollectOverlapping, &Scalar::CollectContained },
+		{ &Sse2::AnyContainsPoint, &Sse2::CollectOverlapping, &Sse2::CollectContained },
+		{ &Avx2::AnyContainsPoint, &Avx2::CollectOverlapping, &Avx2::CollectContained }
+	};
+
+	static void CpuId(int iLeaf, int iSubLeaf, unsigned int uiRegs[4])
+	{
+		//Query CPU information
+
+#if defined(_MSC_VER)
+		__cpuidex((int*)uiRegs, iLeaf, iSubLeaf);
+#else
+		__cpuid_count(iLeaf, iSubLeaf, uiRegs[0], uiRegs[1], uiRegs[2], uiRegs[3]);
+#endif
+	}
+
+	static unsigned long long XGetBv(void)
+	{
+		//Query which register states are enabled by the OS
+
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned int uiLow, uiHigh;
+		__asm__ __volatile__("xgetbv" : "=a"(uiLow), "=d"(uiHigh) : "c"(0));
+		return ((unsigned long long)uiHigh << 32) | uiLow;
+#endif
+	}
+
+	static KernelLevel DetectLevel(void)
+	{
+		//Determine the best supported implementation
+
+		unsigned int uiRegs[4];
+
+		CpuId(0, 0, uiRegs);
+		unsigned int uiMaxLeaf = uiRegs[0];
+
+		CpuId(1, 0, uiRegs);
+		bool bSse2 = (uiRegs[3] & (1 << 26)) != 0;
+		bool bOsAvx = ((uiRegs[2] & (1 << 27)) != 0) && ((uiRegs[2] & (1 << 28)) != 0) && ((XGetBv() & 0x6) == 0x6); //OSXSAVE, AVX and YMM state enabled
+
+		if ((bOsAvx) && (uiMaxLeaf >= 7)) {
+			CpuId(7, 0, uiRegs);
+			if (uiRegs[1] & (1 << 5))
+				return KERNEL_AVX2;
+		}
+
+		return (bSse2) ? KERNEL_SSE2 : KERNEL_SCALAR;
+	}
+
+	static const KernelLevel eSupportedLevel = DetectLevel();
+	static const kernel_table_s* pActiveKernels = &sKernels[eSupportedLevel];
+
+	bool AnyContainsPoint(const rect_columns_s& rRects, int x, int y)
+	{
+		return pActiveKernels->pfnAnyContainsPoint(rRects, x, y);
+	}
+
+	size_t CollectOverlapping(const rect_columns_s& rRects, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut)
+	{
+		return pActiveKernels->pfnCollectOverlapping(rRects, iMinX, iMinY, iMaxX, iMaxY, puiOut);
+	}
+
+	size_t CollectContained(const int* piPoints, size_t uiCount, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut)
+	{
+		return pActiveKernels->pfnCollectContained(piPoints, uiCount, iMinX, iMinY, iMaxX, iMaxY, puiOut);
+	}
+
+	KernelLevel SupportedLevel(void)
+	{
+		return eSupportedLevel;
+	}
+
+	KernelLevel ActiveLevel(void)
+	{
+		return (KernelLevel)(pActiveKernels - sKernels);
+	}
+
+	void SetLevel(KernelLevel eLevel)
+	{
+		//Select implementation, never above what the CPU supports
+
+		if (eLevel > eSupportedLevel)
+			eLevel = eSupportedLevel;
+
+		pActiveKernels = &sKernels[eLevel];
+	}
+
+	const char* LevelName(KernelLevel eLevel)
+	{
+		static const char* szNames[] = { "scalar", "SSE2", "AVX2" };
+
+		return szNames[eLevel];
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+#include "shared.h"
+
+/* Batched integer rectangle tests. Rectangles are passed as columns and all borders are inclusive.
+   The implementation is selected once by the CPU features (AVX2, SSE2 or scalar) */
+namespace RectKernels {
+	enum KernelLevel { KERNEL_SCALAR = 0, KERNEL_SSE2, KERNEL_AVX2 };
+
+	struct rect_columns_s {
+		const int* piMinX;
+		const int* piMinY;
+		const int* piMaxX;
+		const int* piMaxY;
+		size_t uiCount;
+	};
+
+	bool AnyContainsPoint(const rect_columns_s& rRects, int x, int y); //Check if any rectangle contains the point
+	size_t CollectOverlapping(const rect_columns_s& rRects, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut); //Store the indices of all rectangles overlapping the given one, returns the amount
+	size_t CollectContained(const int* piPoints, size_t uiCount, int iMinX, int iMinY, int iMaxX, int iMaxY, size_t* puiOut); //Store the indices of all points (x, y pairs) inside the given rectangle, returns the amount
+
+	KernelLevel SupportedLevel(void);
+	KernelLevel ActiveLevel(void);
+	void SetLevel(KernelLevel eLevel); //Select implementation, limited to what the CPU supports
+	const char* LevelName(KernelLevel eLevel);
+}
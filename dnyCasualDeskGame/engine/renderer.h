@@ -386,6 +386,56 @@ namespace DxRenderer {
 			return sSpriteData.pTexture;
 		}
 
+		const d3dsprite_s* GetSpriteData(const HD3DSPRITE hSprite)
+		{
+			//Get data of a loaded sprite
+
+			size_t uiSprite = this->FindSprite(hSprite);
+			if (uiSprite == GFX_INVALID_LIST_ID)
+				return nullptr;
+
+			return &this->m_vSprites[uiSprite];
+		}
+
+		bool ReadSpritePixels(const HD3DSPRITE hSprite, std::vector<D3DCOLOR>& vPixels, int& iWidth, int& iHeight)
+		{
+			//Read the ARGB pixels of a loaded sprite. The sprite texture itself can not be locked, so a readable copy is loaded from file
+
+			size_t uiSprite = this->FindSprite(hSprite);
+			if (uiSprite == GFX_INVALID_LIST_ID)
+				return false;
+
+			//Use the same dimensions as the sprite texture
+			D3DSURFACE_DESC sDesc;
+			if (FAILED(this->m_vSprites[uiSprite].pTexture->GetLevelDesc(0, &sDesc)))
+				return false;
+
+			LPDIRECT3DTEXTURE9 pTexture;
+			if (FAILED(D3DXCreateTextureFromFileEx(this->m_pDevice, this->m_vSprites[uiSprite].wszFile.c_str(), sDesc.Width, sDesc.Height, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_SCRATCH, D3DX_DEFAULT, D3DX_DEFAULT, 0xFF000000, nullptr, nullptr, &pTexture))) {
+				return false;
+			}
+
+			D3DLOCKED_RECT sLockedRect;
+			if (FAILED(pTexture->LockRect(0, &sLockedRect, nullptr, D3DLOCK_READONLY))) {
+				pTexture->Release();
+				return false;
+			}
+
+			//Copy rows
+			iWidth = (int)sDesc.Width;
+			iHeight = (int)sDesc.Height;
+			vPixels.resize((size_t)iWidth * iHeight);
+
+			for (int y = 0; y < iHeight; y++) {
+				memcpy(&vPixels[(size_t)y * iWidth], (const byte*)sLockedRect.pBits + (size_t)y * sLockedRect.Pitch, iWidth * sizeof(D3DCOLOR));
+			}
+
+			pTexture->UnlockRect(0);
+			pTexture->Release();
+
+			return true;
+		}
+
 		bool FreeSprite(HD3DSPRITE hSprite)
 		{
 			//Free the sprite resources
@@ -0,0 +1,114 @@
+#pragma once
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+#include "shared.h"
+
+/* Simulation scheduler component */
+namespace Scheduler {
+	#define SCHED_DEFAULT_TICK_RATE 60
+	#define SCHED_MAX_STEPS_PER_FRAME 5
+
+	class IClock { //Time source of the scheduler. Can be replaced by a fake clock for testing
+	public:
+		virtual ~IClock() {}
+
+		virtual double Now(void) = 0; //Current time in seconds
+	};
+
+	class CPerformanceClock : public IClock { //High resolution clock based on the performance counter
+	private:
+		LARGE_INTEGER m_liFrequency;
+	public:
+		CPerformanceClock() { QueryPerformanceFrequency(&this->m_liFrequency); }
+		virtual ~CPerformanceClock() {}
+
+		virtual double Now(void)
+		{
+			//Get current time in seconds
+
+			LARGE_INTEGER liCounter;
+			QueryPerformanceCounter(&liCounter);
+
+			return (double)liCounter.QuadPart / (double)this->m_liFrequency.QuadPart;
+		}
+	};
+
+	class CFixedStepScheduler { //Fixed timestep scheduler with accumulator
+	private:
+		IClock* m_pClock;
+		double m_dblStep;
+		double m_dblLastTime;
+		double m_dblAccumulator;
+		unsigned int m_uiMaxSteps;
+		unsigned long long m_ullTickCount;
+	public:
+		CFixedStepScheduler() : m_pClock(nullptr), m_dblStep(1.0 / SCHED_DEFAULT_TICK_RATE), m_dblLastTime(0.0), m_dblAccumulator(0.0), m_uiMaxSteps(SCHED_MAX_STEPS_PER_FRAME), m_ullTickCount(0) {}
+		CFixedStepScheduler(IClock* pClock, unsigned int uiTickRate) : m_pClock(nullptr), m_dblStep(1.0 / SCHED_DEFAULT_TICK_RATE), m_dblLastTime(0.0), m_dblAccumulator(0.0), m_uiMaxSteps(SCHED_MAX_STEPS_PER_FRAME), m_ullTickCount(0)
+		{
+			this->SetTickRate(uiTickRate);
+			this->SetClock(pClock);
+		}
+		~CFixedStepScheduler() {}
+
+		void Reset(void)
+		{
+			//Restart time measurement
+
+			this->m_dblLastTime = (this->m_pClock) ? this->m_pClock->Now() : 0.0;
+			this->m_dblAccumulator = 0.0;
+		}
+
+		unsigned int Advance(void)
+		{
+			//Accumulate elapsed time and return the amount of simulation steps to run now
+
+			if (!this->m_pClock)
+				return 0;
+
+			double dblNow = this->m_pClock->Now();
+			double dblElapsed = dblNow - this->m_dblLastTime;
+			this->m_dblLastTime = dblNow;
+
+			if (dblElapsed < 0.0)
+				dblElapsed = 0.0;
+
+			//Drop time that can not be caught up with, so that slow steps do not pile up more and more steps
+			if (dblElapsed > this->m_dblStep * this->m_uiMaxSteps)
+				dblElapsed = this->m_dblStep * this->m_uiMaxSteps;
+
+			this->m_dblAccumulator += dblElapsed;
+
+			unsigned int uiSteps = 0;
+			while ((this->m_dblAccumulator >= this->m_dblStep) && (uiSteps < this->m_uiMaxSteps)) {
+				this->m_dblAccumulator -= this->m_dblStep;
+				uiSteps++;
+			}
+
+			this->m_ullTickCount += uiSteps;
+
+			return uiSteps;
+		}
+
+		//Setters
+		inline void SetClock(IClock* pClock) { this->m_pClock = pClock; this->Reset(); }
+		inline void SetTickRate(unsigned int uiTickRate) { if (uiTickRate) this->m_dblStep = 1.0 / (double)uiTickRate; }
+		inline void SetMaxStepsPerFrame(unsigned int uiMaxSteps) { if (uiMaxSteps) this->m_uiMaxSteps = uiMaxSteps; }
+
+		//Getters
+		inline double StepTime(void) const { return this->m_dblStep; }
+		inline float Alpha(void) const { return (float)(this->m_dblAccumulator / this->m_dblStep); } //Fraction of the next step that has elapsed (render interpolation)
+		inline double TimeToNextStep(void) const { return this->m_dblStep - this->m_dblAccumulator; }
+		inline unsigned long long TickCount(void) const { return this->m_ullTickCount; }
+	};
+}
@@ -16,7 +16,39 @@
 */
 
 namespace Scripting {
-	CScriptInt::CScriptInt(const std::string& szScriptDir, void* pCallbackFunction) : m_bInitialized(false)
+	class CByteCodeStream : public asIBinaryStream { //Binary stream of a bytecode cache file
+	private:
+		std::fstream& m_rFile;
+	public:
+		CByteCodeStream(std::fstream& rFile) : m_rFile(rFile) {}
+		virtual ~CByteCodeStream() {}
+
+		virtual int Read(void* ptr, asUINT size)
+		{
+			//Read data from file
+
+			if (!size)
+				return 0;
+
+			this->m_rFile.read((char*)ptr, size);
+
+			return (this->m_rFile.gcount() == (std::streamsize)size) ? 0 : -1;
+		}
+
+		virtual int Write(const void* ptr, asUINT size)
+		{
+			//Write data to file
+
+			if (!size)
+				return 0;
+
+			this->m_rFile.write((const char*)ptr, size);
+
+			return (this->m_rFile.good()) ? 0 : -1;
+		}
+	};
+
+	CScriptInt::CScriptInt(const std::string& szScriptDir, void* pCallbackFunction) : m_bInitialized(false), m_uiContextPoolSize(SI_CONTEXT_POOL_SIZE), m_uiContextsCreated(0), m_uiContextsReused(0), m_uiScriptsCompiled(0), m_uiScriptsFromCache(0), m_ullInterfaceHash(0), m_bInterfaceHashed(false)
 	{
 		//Construct object
 
@@ -50,6 +82,9 @@ namespace Scripting {
 		//Register math functions
 		RegisterScriptMath(this->m_pScriptEngine);
 
+		//Free method tables together with their types
+		this->m_pScriptEngine->SetTypeInfoUserDataCleanupCallback(&CScriptInt::CleanupMethodTable, SI_USERDATA_METHOD_TABLE);
+
 		//Save script path
 		this->m_szScriptPath = szScriptDir;
 
@@ -69,6 +104,12 @@ namespace Scripting {
 			this->UnloadScript(i);
 		}
 
+		//Free pooled contexts
+		for (size_t i = 0; i < this->m_vContextPool.size(); i++) {
+			this->m_vContextPool[i]->Release();
+		}
+		this->m_vContextPool.clear();
+
 		//Shutdown AngelScript
 		if (this->m_pScriptEngine) {
 			this->m_pScriptEngine->ShutDownAndRelease();
@@ -79,33 +120,288 @@ namespace Scripting {
 		this->m_bInitialized = false;
 	}
 
+	asIScriptContext* CScriptInt::AcquireContext(void)
+	{
+		//Get an unused context from the pool. If all are in use, e.g. when a script calls back into the host which calls a script again, a new one is created
+
+		if (this->m_vContextPool.size()) {
+			asIScriptContext* pContext = this->m_vContextPool.back();
+			this->m_vContextPool.pop_back();
+			this->m_uiContextsReused++;
+
+			return pContext;
+		}
+
+		this->m_uiContextsCreated++;
+
+		return this->m_pScriptEngine->CreateContext();
+	}
+
+	void CScriptInt::ReleaseContext(asIScriptContext* pContext)
+	{
+		//Return context to the pool. Contexts that can not be reset or exceed the pool size are released
+
+		if ((this->m_vContextPool.size() >= this->m_uiContextPoolSize) || (AS_FAILED(pContext->Unprepare()))) {
+			pContext->Release();
+			return;
+		}
+
+		this->m_vContextPool.push_back(pContext);
+	}
+
+	void CScriptInt::SetContextPoolSize(size_t uiSize)
+	{
+		//Set the amount of unused contexts kept for reuse, surplus contexts are released. A size of 0 creates a new context for every call
+
+		this->m_uiContextPoolSize = uiSize;
+
+		while (this->m_vContextPool.size() > this->m_uiContextPoolSize) {
+			this->m_vContextPool.back()->Release();
+			this->m_vContextPool.pop_back();
+		}
+	}
+
+	unsigned long long CScriptInt::HashData(const char* pData, size_t uiSize, unsigned long long ullHash)
+	{
+		//Continue a 64 bit FNV-1a hash with the given data
+
+		for (size_t i = 0; i < uiSize; i++) {
+			ullHash = (ullHash ^ (unsigned char)pData[i]) * 1099511628211ULL;
+		}
+
+		return ullHash;
+	}
+
+	bool CScriptInt::HashFile(const std::string& szFileName, unsigned long long& ullHash)
+	{
+		//Hash the content of a file
+
+		std::ifstream hFile(szFileName, std::ifstream::in | std::ifstream::binary);
+		if (!hFile.is_open())
+			return false;
+
+		std::string szContent((std::istreambuf_iterator<char>(hFile)), std::istreambuf_iterator<char>());
+
+		ullHash = HashData(szContent.data(), szContent.length(), 14695981039346656037ULL);
+
+		return true;
+	}
+
+	std::string CScriptInt::InterfaceSignature(void)
+	{
+		//Build a text of everything registered by the host, so that changes of the interface invalidate cached bytecode
+
+		std::string szResult = std::string(asGetLibraryVersion()) + "|" + asGetLibraryOptions() + "|" + std::to_string(DNY_CDG_HOST_VERSION_W) + "\n";
+
+		for (asUINT i = 0; i < this->m_pScriptEngine->GetGlobalFunctionCount(); i++) {
+			szResult += std::string(this->m_pScriptEngine->GetGlobalFunctionByIndex(i)->GetDeclaration(true, true, true)) + "\n";
+		}
+
+		for (asUINT i = 0; i < this->m_pScriptEngine->GetGlobalPropertyCount(); i++) {
+			const char* szName = nullptr;
+			int iTypeId = 0;
+			this->m_pScriptEngine->GetGlobalPropertyByIndex(i, &szName, nullptr, &iTypeId);
+			szResult += std::string(this->m_pScriptEngine->GetTypeDeclaration(iTypeId, true)) + " " + szName + "\n";
+		}
+
+		for (asUINT i = 0; i < this->m_pScriptEngine->GetObjectTypeCount(); i++) {
+			asITypeInfo* pTypeInfo = this->m_pScriptEngine->GetObjectTypeByIndex(i);
+			szResult += std::string(pTypeInfo->GetName()) + " " + std::to_string(pTypeInfo->GetSize()) + "\n";
+
+			for (asUINT j = 0; j < pTypeInfo->GetPropertyCount(); j++) {
+				szResult += std::string(pTypeInfo->GetPropertyDeclaration(j)) + "\n";
+			}
+
+			for (asUINT j = 0; j < pTypeInfo->GetMethodCount(); j++) {
+				szResult += std::string(pTypeInfo->GetMethodByIndex(j)->GetDeclaration(true, true, true)) + "\n";
+			}
+		}
+
+		for (asUINT i = 0; i < this->m_pScriptEngine->GetEnumCount(); i++) {
+			asITypeInfo* pTypeInfo = this->m_pScriptEngine->GetEnumByIndex(i);
+			szResult += std::string(pTypeInfo->GetName()) + "\n";
+
+			for (asUINT j = 0; j < pTypeInfo->GetEnumValueCount(); j++) {
+				int iValue = 0;
+				szResult += std::string(pTypeInfo->GetEnumValueByIndex(j, &iValue)) + "=" + std::to_string(iValue) + "\n";
+			}
+		}
+
+		for (asUINT i = 0; i < this->m_pScriptEngine->GetFuncdefCount(); i++) {
+			szResult += std::string(this->m_pScriptEngine->GetFuncdefByIndex(i)->GetFuncdefSignature()->GetDeclaration(true, true, true)) + "\n";
+		}
+
+		for (asUINT i = 0; i < this->m_pScriptEngine->GetTypedefCount(); i++) {
+			asITypeInfo* pTypeInfo = this->m_pScriptEngine->GetTypedefByIndex(i);
+			szResult += std::string(pTypeInfo->GetName()) + "=" + std::to_string(pTypeInfo->GetTypedefTypeId()) + "\n";
+		}
+
+		return szResult;
+	}
+
+	std::string CScriptInt::ByteCodeKey(const std::string& szScriptName)
+	{
+		//Hash script name and interface into the name of the cache file. The sections of the script are checked when loading it.
+		//The interface is hashed once, as the host registers it completely before the first script is loaded
+
+		if (!this->m_bInterfaceHashed) {
+			std::string szInterface = this->InterfaceSignature();
+			this->m_ullInterfaceHash = HashData(szInterface.data(), szInterface.length(), 14695981039346656037ULL);
+			this->m_bInterfaceHashed = true;
+		}
+
+		unsigned long long ullHash = HashData(szScriptName.data(), szScriptName.length(), this->m_ullInterfaceHash);
+
+		static const char szDigits[] = "0123456789abcdef";
+		std::string szKey(16, '0');
+
+		for (size_t i = 16; i > 0; i--) {
+			szKey[i - 1] = szDigits[ullHash & 0xF];
+			ullHash >>= 4;
+		}
+
+		return szKey;
+	}
+
+	asIScriptModule* CScriptInt::LoadByteCode(const std::string& szModuleName, const std::string& szCacheFile)
+	{
+		//Create module from cached bytecode, nullptr if there is no valid cache file or one of the script sections has changed
+
+		std::fstream hFile(szCacheFile, std::fstream::in | std::fstream::binary);
+		if (!hFile.is_open())
+			return nullptr;
+
+		//Check section list, which precedes the bytecode
+		unsigned int uiSections = 0;
+		if (!hFile.read((char*)&uiSections, sizeof(uiSections)))
+			return nullptr;
+
+		for (unsigned int i = 0; i < uiSections; i++) {
+			unsigned int uiNameLength = 0;
+			unsigned long long ullStoredHash = 0, ullHash = 0;
+
+			if (!hFile.read((char*)&uiNameLength, sizeof(uiNameLength)))
+				return nullptr;
+
+			std::string szSection(uiNameLength, '\0');
+			if ((!hFile.read(&szSection[0], uiNameLength)) || (!hFile.read((char*)&ullStoredHash, sizeof(ullStoredHash))))
+				return nullptr;
+
+			if ((!HashFile(szSection, ullHash)) || (ullHash != ullStoredHash))
+				return nullptr;
+		}
+
+		asIScriptModule* pModule = this->m_pScriptEngine->GetModule(szModuleName.c_str(), asGM_ALWAYS_CREATE);
+		if (!pModule)
+			return nullptr;
+
+		CByteCodeStream oStream(hFile);
+		if (AS_FAILED(pModule->LoadByteCode(&oStream))) {
+			this->m_pScriptEngine->DiscardModule(szModuleName.c_str());
+			return nullptr;
+		}
+
+		return pModule;
+	}
+
+	bool CScriptInt::SaveByteCode(asIScriptModule* pModule, const std::vector<std::string>& vSections, const std::string& szCacheFile)
+	{
+		//Store the script sections with their hashes and the bytecode of the compiled module. Incomplete files are removed so they are not loaded later
+
+		std::fstream hFile(szCacheFile, std::fstream::out | std::fstream::binary | std::fstream::trunc);
+		if (!hFile.is_open())
+			return false;
+
+		bool bResult = true;
+
+		unsigned int uiSections = (unsigned int)vSections.size();
+		hFile.write((const char*)&uiSections, sizeof(uiSections));
+
+		for (size_t i = 0; (i < vSections.size()) && (bResult); i++) {
+			unsigned int uiNameLength = (unsigned int)vSections[i].length();
+			unsigned long long ullHash = 0;
+
+			bResult = HashFile(vSections[i], ullHash);
+
+			hFile.write((const char*)&uiNameLength, sizeof(uiNameLength));
+			hFile.write(vSections[i].data(), uiNameLength);
+			hFile.write((const char*)&ullHash, sizeof(ullHash));
+		}
+
+		CByteCodeStream oStream(hFile);
+		bResult = (bResult) && (hFile.good()) && (!AS_FAILED(pModule->SaveByteCode(&oStream)));
+
+		hFile.close();
+
+		if (!bResult)
+			DeleteFileA(szCacheFile.c_str());
+
+		return bResult;
+	}
+
+	void CScriptInt::SetByteCodeCacheDir(const std::string& szDirectory)
+	{
+		//Set directory of the bytecode cache and create it if required
+
+		this->m_szByteCodeDir = szDirectory;
+
+		if (szDirectory.length())
+			CreateDirectoryA(szDirectory.c_str(), nullptr);
+	}
+
 	HSISCRIPT CScriptInt::LoadScript(const std::string& szScriptName)
 	{
-		//Load script
+		//Load script, from the bytecode cache if it holds a copy built from the same sections and interface
 
 		if ((!this->m_bInitialized) || (!szScriptName.length()))
 			return SI_INVALID_ID;
 
-		CScriptBuilder oScriptBuilder;
+		asIScriptModule* pModule = nullptr;
+		std::string szCacheFile;
 
-		//Start new module
-		if (AS_FAILED(oScriptBuilder.StartNewModule(this->m_pScriptEngine, szScriptName.c_str())))
-			return SI_INVALID_ID;
+		if (this->m_szByteCodeDir.length()) {
+			szCacheFile = this->m_szByteCodeDir + "\\" + this->ByteCodeKey(szScriptName) + SI_BYTECODE_FILE_EXT;
+			pModule = this->LoadByteCode(szScriptName, szCacheFile);
+		}
 
-		//Add script file to module
-		if (AS_FAILED(oScriptBuilder.AddSectionFromFile((/*this->m_szScriptPath +*/ szScriptName).c_str())))
-			return SI_INVALID_ID;
+		if (pModule) {
+			this->m_uiScriptsFromCache++;
+		} else {
+			CScriptBuilder oScriptBuilder;
 
-		//Build script module
-		if (AS_FAILED(oScriptBuilder.BuildModule()))
-			return SI_INVALID_ID;
+			//Start new module
+			if (AS_FAILED(oScriptBuilder.StartNewModule(this->m_pScriptEngine, szScriptName.c_str())))
+				return SI_INVALID_ID;
+
+			//Add script file to module
+			if (AS_FAILED(oScriptBuilder.AddSectionFromFile((/*this->m_szScriptPath +*/ szScriptName).c_str())))
+				return SI_INVALID_ID;
+
+			//Build script module
+			if (AS_FAILED(oScriptBuilder.BuildModule()))
+				return SI_INVALID_ID;
+
+			pModule = this->m_pScriptEngine->GetModule(szScriptName.c_str()); //Get pointer to script module
+			if (!pModule)
+				return SI_INVALID_ID;
+
+			this->m_uiScriptsCompiled++;
+
+			//Store for the next start together with all sections, including the ones added by #include
+			if (szCacheFile.length()) {
+				std::vector<std::string> vSections;
+				for (unsigned int i = 0; i < oScriptBuilder.GetSectionCount(); i++) {
+					vSections.push_back(oScriptBuilder.GetSectionName(i));
+				}
+
+				this->SaveByteCode(pModule, vSections, szCacheFile);
+			}
+		}
 
 		//Setup struct
 		si_script_s sScriptData;
 		sScriptData.szName = szScriptName;
-		sScriptData.pModule = this->m_pScriptEngine->GetModule(szScriptName.c_str()); //Get pointer to script module
-		if (!sScriptData.pModule)
-			return SI_INVALID_ID;
+		sScriptData.pModule = pModule;
 
 		//Add to list
 		this->m_vScripts.push_back(sScriptData);
@@ -152,14 +448,14 @@ namespace Scripting {
 		if (!pFunction)
 			return false;
 		
-		//Create calling context
-		asIScriptContext* pContext = this->m_pScriptEngine->CreateContext();
+		//Acquire calling context
+		asIScriptContext* pContext = this->AcquireContext();
 		if (!pContext)
 			return false;
 		
 		//Prepare call stack
 		if (AS_FAILED(pContext->Prepare(pFunction))) {
-			pContext->Release();
+			this->ReleaseContext(pContext);
 			return false;
 		}
 		
@@ -198,14 +494,14 @@ namespace Scripting {
 					iArgResult = pContext->SetArgObject((asUINT)i, (*pArgs)[i].ptr);
 					break;
 				default:
-					pContext->Release();
+					this->ReleaseContext(pContext);
 					return false;
 					break;
 				}
 
 				//Validate result
 				if (AS_FAILED(iArgResult)) {
-					pContext->Release();
+					this->ReleaseContext(pContext);
 					return false;
 				}
 			}
@@ -213,7 +509,7 @@ namespace Scripting {
 
 		//Call function
 		if (!AS_EXECUTED(pContext->Execute())) {
-			pContext->Release();
+			this->ReleaseContext(pContext);
 			return false;
 		}
 
@@ -249,13 +545,13 @@ namespace Scripting {
 				*(void**)pResult = pContext->GetReturnObject();
 				break;
 			default:
-				pContext->Release();
+				this->ReleaseContext(pContext);
 				return false;
 				break;
 			}
 		}
 
-		pContext->Release();
+		this->ReleaseContext(pContext);
 
 		return true;
 	}
@@ -270,14 +566,14 @@ namespace Scripting {
 		if (!pFunction)
 			return false;
 
-		//Create calling context
-		asIScriptContext* pContext = this->m_pScriptEngine->CreateContext();
+		//Acquire calling context
+		asIScriptContext* pContext = this->AcquireContext();
 		if (!pContext)
 			return false;
 
 		//Prepare call stack
 		if (AS_FAILED(pContext->Prepare(pFunction))) {
-			pContext->Release();
+			this->ReleaseContext(pContext);
 			return false;
 		}
 
@@ -316,14 +612,14 @@ namespace Scripting {
 					iArgResult = pContext->SetArgObject((asUINT)i, (*pArgs)[i].ptr);
 					break;
 				default:
-					pContext->Release();
+					this->ReleaseContext(pContext);
 					return false;
 					break;
 				}
 
 				//Validate result
 				if (AS_FAILED(iArgResult)) {
-					pContext->Release();
+					this->ReleaseContext(pContext);
 					return false;
 				}
 			}
@@ -331,7 +627,7 @@ namespace Scripting {
 
 		//Call function
 		if (!AS_EXECUTED(pContext->Execute())) {
-			pContext->Release();
+			this->ReleaseContext(pContext);
 			return false;
 		}
 
@@ -364,17 +660,31 @@ namespace Scripting {
 				*(void**)pResult = pContext->GetReturnAddress();
 				break;
 			default:
-				pContext->Release();
+				this->ReleaseContext(pContext);
 				return false;
 				break;
 			}
 		}
 
-		pContext->Release();
+		this->ReleaseContext(pContext);
 
 		return true;
 	}
 
+	asIScriptFunction* CScriptInt::GetScriptFunction(const HSISCRIPT hScript, const std::string& szFunctionName)
+	{
+		//Get function by name, nullptr if it does not exist
+
+		if (!this->m_bInitialized)
+			return nullptr;
+
+		//Validate script handle
+		if ((hScript == SI_INVALID_ID) || (hScript >= this->m_vScripts.size()))
+			return nullptr;
+
+		return this->m_vScripts[hScript].pModule->GetFunctionByName(szFunctionName.c_str());
+	}
+
 	bool CScriptInt::ScriptFunctionExists(const HSISCRIPT hScript, const std::string& szFunctionName)
 	{
 		//Check if a script function does exist
@@ -608,8 +918,8 @@ namespace Scripting {
 			return nullptr;
 		}
 
-		//Create calling context
-		asIScriptContext* pContext = this->m_pScriptEngine->CreateContext();
+		//Acquire calling context
+		asIScriptContext* pContext = this->AcquireContext();
 		if (!pContext) {
 			pTypeInfo->Release();
 			return nullptr;
@@ -622,52 +932,58 @@ namespace Scripting {
 		//Obtain handle to returned object
 		asIScriptObject* pObject = *(asIScriptObject**)pContext->GetAddressOfReturnValue();
 		if (!pObject) {
-			pContext->Release();
+			this->ReleaseContext(pContext);
 			pTypeInfo->Release();
+			return nullptr;
 		}
 		
 		//Increment reference counter in order to store object
 		pObject->AddRef();
 
+		this->ReleaseContext(pContext);
+
 		return pObject;
 	}
 
 	bool CScriptInt::CallScriptMethod(const HSISCRIPT hScript, asIScriptObject* pClassInstance, const std::string& szMethodDef, const std::vector<si_func_arg>* pArgs, void* pResult, func_args_e eResultType)
 	{
-		if (!this->m_bInitialized)
-			return false;
+		//Resolve method by declaration and call it
 
 		if (!pClassInstance)
 			return false;
-		
-		//Create calling context
-		asIScriptContext* pContext = this->m_pScriptEngine->CreateContext();
-		if (!pContext)
-			return false;
 
 		//Query object type
 		asITypeInfo* pTypeInfo = pClassInstance->GetObjectType();
-		if (!pTypeInfo) {
-			pContext->Release();
+		if (!pTypeInfo)
 			return false;
-		}
 
-		//Query class method
-		asIScriptFunction* pFunction = pTypeInfo->GetMethodByDecl(szMethodDef.c_str());
-		if (!pFunction) {
-			pContext->Release();
+		return this->CallScriptMethod(pClassInstance, pTypeInfo->GetMethodByDecl(szMethodDef.c_str()), pArgs, pResult, eResultType);
+	}
+
+	bool CScriptInt::CallScriptMethod(asIScriptObject* pClassInstance, asIScriptFunction* pFunction, const std::vector<si_func_arg>* pArgs, void* pResult, func_args_e eResultType)
+	{
+		//Call already resolved method of class instance
+
+		if (!this->m_bInitialized)
+			return false;
+
+		if ((!pClassInstance) || (!pFunction))
+			return false;
+		
+		//Acquire calling context
+		asIScriptContext* pContext = this->AcquireContext();
+		if (!pContext)
 			return false;
-		}
 
 		//Prepare call stack
 		if (AS_FAILED(pContext->Prepare(pFunction))) {
-			pContext->Release();
+			this->ReleaseContext(pContext);
 			return false;
 		}
 
 		//Set object instance pointer
 		if (AS_FAILED(pContext->SetObject(pClassInstance))) {
-			pContext->Release();
+			this->ReleaseContext(pContext);
 			return false;
 		}
 
@@ -706,14 +1022,14 @@ namespace Scripting {
 					iArgResult = pContext->SetArgObject((asUINT)i, (*pArgs)[i].ptr);
 					break;
 				default:
-					pContext->Release();
+					this->ReleaseContext(pContext);
 					return false;
 					break;
 				}
 
 				//Validate result
 				if (AS_FAILED(iArgResult)) {
-					pContext->Release();
+					this->ReleaseContext(pContext);
 					return false;
 				}
 			}
@@ -721,7 +1037,7 @@ namespace Scripting {
 
 		//Call function
 		if (!AS_EXECUTED(pContext->Execute())) {
-			pContext->Release();
+			this->ReleaseContext(pContext);
 			return false;
 		}
 
@@ -757,17 +1073,50 @@ namespace Scripting {
 				*(void**)pResult = pContext->GetReturnAddress();
 				break;
 			default:
-				pContext->Release();
+				this->ReleaseContext(pContext);
 				return false;
 				break;
 			}
 		}
 
-		pContext->Release();
+		this->ReleaseContext(pContext);
 
 		return true;
 	}
 
+	const si_method_table_s* CScriptInt::GetMethodTable(asITypeInfo* pTypeInfo, const char* const* ppDecls, size_t uiCount)
+	{
+		//Get the methods of the given declarations for a script type. The table is resolved once and attached to the type, so it is freed together with it
+
+		if (!pTypeInfo)
+			return nullptr;
+
+		si_method_table_s* pTable = (si_method_table_s*)pTypeInfo->GetUserData(SI_USERDATA_METHOD_TABLE);
+		if ((pTable) && (pTable->ppDecls == ppDecls))
+			return pTable;
+
+		if (!pTable) {
+			pTable = new si_method_table_s();
+			pTypeInfo->SetUserData(pTable, SI_USERDATA_METHOD_TABLE);
+		}
+
+		pTable->ppDecls = ppDecls;
+		pTable->vMethods.resize(uiCount);
+
+		for (size_t i = 0; i < uiCount; i++) {
+			pTable->vMethods[i] = pTypeInfo->GetMethodByDecl(ppDecls[i]); //Null if not implemented
+		}
+
+		return pTable;
+	}
+
+	void CScriptInt::CleanupMethodTable(asITypeInfo* pTypeInfo)
+	{
+		//Free method table of a type that is being destroyed
+
+		delete (si_method_table_s*)pTypeInfo->GetUserData(SI_USERDATA_METHOD_TABLE);
+	}
+
 	bool CScriptInt::RegisterInterface(const std::string& szName)
 	{
 		//Register interface
@@ -13,6 +13,7 @@
 */
 
 #include "shared.h"
+#include <type_traits>
 #include <angelscript.h>
 #include <scriptarray\scriptarray.h>
 
@@ -20,6 +21,9 @@
 #define AS_FAILED(r) (r < 0)
 #define AS_EXECUTED(r) (r == asEXECUTION_FINISHED)
 #define SI_INVALID_ID ((size_t)-1)
+#define SI_CONTEXT_POOL_SIZE 16
+#define SI_USERDATA_METHOD_TABLE 1000
+#define SI_BYTECODE_FILE_EXT ".asbc"
 #define BEGIN_PARAMS(lv) std::vector<Scripting::si_func_arg> lv; Scripting::si_func_arg lv##_sSIArg_;
 #define PUSH_PARAM(t, n, v, lv) lv##_sSIArg_.eType = t; lv##_sSIArg_.##n = v; lv.push_back(lv##_sSIArg_);
 #define PUSH_BOOL(var) PUSH_PARAM(Scripting::FA_BYTE, byte, (byte)var, vArgs);
@@ -85,6 +89,45 @@ namespace Scripting {
 		};
 	};
 
+	struct si_method_table_s {
+		const char* const* ppDecls;
+		std::vector<asIScriptFunction*> vMethods;
+	};
+
+	/* Typed call arguments. The overload is selected at compile time by the C++ type of the argument */
+	struct si_address_s { //Passes a pointer as address instead of object (same as FA_POINTER)
+		void* ptr;
+	};
+
+	inline si_address_s Address(void* ptr) { si_address_s sAddress; sAddress.ptr = ptr; return sAddress; }
+
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, bool bValue) { return pContext->SetArgByte(uiArg, (asBYTE)bValue); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, asBYTE ucValue) { return pContext->SetArgByte(uiArg, ucValue); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, asWORD wValue) { return pContext->SetArgWord(uiArg, wValue); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, int iValue) { return pContext->SetArgDWord(uiArg, (asDWORD)iValue); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, asDWORD dwValue) { return pContext->SetArgDWord(uiArg, dwValue); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, asQWORD qwValue) { return pContext->SetArgQWord(uiArg, qwValue); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, float flValue) { return pContext->SetArgFloat(uiArg, flValue); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, double dblValue) { return pContext->SetArgDouble(uiArg, dblValue); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, std::string* pString) { return pContext->SetArgAddress(uiArg, pString); }
+	inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, si_address_s sAddress) { return pContext->SetArgAddress(uiArg, sAddress.ptr); }
+	template <typename TObject> inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, TObject* pObject) { return pContext->SetArgObject(uiArg, (void*)pObject); }
+	template <typename TEnum, typename = typename std::enable_if<std::is_enum<TEnum>::value>::type> inline int SetCallArg(asIScriptContext* pContext, asUINT uiArg, TEnum eValue) { return pContext->SetArgDWord(uiArg, (asDWORD)eValue); }
+
+	/* Typed call results */
+	template <typename TResult> struct si_call_result_s;
+	template <> struct si_call_result_s<void> { static void Get(asIScriptContext* pContext, void* pResult) {} };
+	template <> struct si_call_result_s<bool> { static void Get(asIScriptContext* pContext, bool* pResult) { *pResult = pContext->GetReturnByte() != 0; } };
+	template <> struct si_call_result_s<asBYTE> { static void Get(asIScriptContext* pContext, asBYTE* pResult) { *pResult = pContext->GetReturnByte(); } };
+	template <> struct si_call_result_s<asWORD> { static void Get(asIScriptContext* pContext, asWORD* pResult) { *pResult = pContext->GetReturnWord(); } };
+	template <> struct si_call_result_s<int> { static void Get(asIScriptContext* pContext, int* pResult) { *pResult = (int)pContext->GetReturnDWord(); } };
+	template <> struct si_call_result_s<asDWORD> { static void Get(asIScriptContext* pContext, asDWORD* pResult) { *pResult = pContext->GetReturnDWord(); } };
+	template <> struct si_call_result_s<asQWORD> { static void Get(asIScriptContext* pContext, asQWORD* pResult) { *pResult = pContext->GetReturnQWord(); } };
+	template <> struct si_call_result_s<float> { static void Get(asIScriptContext* pContext, float* pResult) { *pResult = pContext->GetReturnFloat(); } };
+	template <> struct si_call_result_s<double> { static void Get(asIScriptContext* pContext, double* pResult) { *pResult = pContext->GetReturnDouble(); } };
+	template <> struct si_call_result_s<std::string> { static void Get(asIScriptContext* pContext, std::string* pResult) { *pResult = *(std::string*)pContext->GetReturnObject(); } };
+	template <typename TObject> struct si_call_result_s<TObject*> { static void Get(asIScriptContext* pContext, TObject** pResult) { *pResult = (TObject*)pContext->GetReturnAddress(); } }; //References returned by script methods
+
 	/* Scripting interface component */
 	class CScriptInt {
 	private:
@@ -95,8 +138,27 @@ namespace Scripting {
 		std::vector<si_enum_s> m_vEnums;
 		std::vector<si_struct_s> m_vStructs;
 		std::vector<si_class_s> m_vClasses;
+		std::vector<asIScriptContext*> m_vContextPool;
+		size_t m_uiContextPoolSize;
+		size_t m_uiContextsCreated;
+		size_t m_uiContextsReused;
+		std::string m_szByteCodeDir;
+		size_t m_uiScriptsCompiled;
+		size_t m_uiScriptsFromCache;
+		unsigned long long m_ullInterfaceHash;
+		bool m_bInterfaceHashed;
+
+		asIScriptContext* AcquireContext(void);
+		void ReleaseContext(asIScriptContext* pContext);
+		static void CleanupMethodTable(asITypeInfo* pTypeInfo);
+		static unsigned long long HashData(const char* pData, size_t uiSize, unsigned long long ullHash);
+		static bool HashFile(const std::string& szFileName, unsigned long long& ullHash);
+		std::string InterfaceSignature(void);
+		std::string ByteCodeKey(const std::string& szScriptName);
+		asIScriptModule* LoadByteCode(const std::string& szModuleName, const std::string& szCacheFile);
+		bool SaveByteCode(asIScriptModule* pModule, const std::vector<std::string>& vSections, const std::string& szCacheFile);
 	public:
-		CScriptInt() : m_bInitialized(false) {}
+		CScriptInt() : m_bInitialized(false), m_uiContextPoolSize(SI_CONTEXT_POOL_SIZE), m_uiContextsCreated(0), m_uiContextsReused(0), m_uiScriptsCompiled(0), m_uiScriptsFromCache(0), m_ullInterfaceHash(0), m_bInterfaceHashed(false) {}
 		CScriptInt(const std::string& szScriptDir, void* pCallbackFunction);
 		~CScriptInt() { if (this->m_bInitialized) this->Shutdown(); }
 
@@ -106,6 +168,7 @@ namespace Scripting {
 		virtual void Shutdown(void);
 
 		virtual HSISCRIPT LoadScript(const std::string& szScriptName);
+		void SetByteCodeCacheDir(const std::string& szDirectory); //Compiled scripts are stored there and loaded again while their source and the registered interface are unchanged. Empty to disable
 		virtual bool UnloadScript(const HSISCRIPT hScript);
 
 		virtual bool CallScriptFunction(const HSISCRIPT hScript, const bool bIsName, const std::string& szFunctionNameOrDeclaration, const std::vector<si_func_arg>* pArgs, void* pResult, func_args_e eResultType = FA_VOID);
@@ -127,8 +190,66 @@ namespace Scripting {
 		virtual asITypeInfo* GetTypeInfo(const std::string& szTypeText, bool bNameOrDef);
 		virtual asIScriptObject* AllocClass(const HSISCRIPT hScript, const std::string& szClassName);
 		virtual bool CallScriptMethod(const HSISCRIPT hScript, asIScriptObject* pClassInstance, const std::string& szMethodDef, const std::vector<si_func_arg>* pArgs, void* pResult, func_args_e eResultType = FA_VOID);
+		bool CallScriptMethod(asIScriptObject* pClassInstance, asIScriptFunction* pFunction, const std::vector<si_func_arg>* pArgs, void* pResult, func_args_e eResultType = FA_VOID);
+		const si_method_table_s* GetMethodTable(asITypeInfo* pTypeInfo, const char* const* ppDecls, size_t uiCount);
 		virtual bool RegisterInterface(const std::string& szName);
 		virtual bool RegisterInterfaceMethod(const std::string& szIfName, const std::string& szTypedef);
+
+		template <typename TResult, typename... TArgs>
+		bool Call(asIScriptFunction* pFunction, asIScriptObject* pClassInstance, TResult* pResult, TArgs... args)
+		{
+			//Call a resolved function, or a method if an instance is given. Arguments and result are passed according to their types
+			//without building an argument list, e.g. Call<bool>(pFunction, pObject, &bResult, 10, 2.0f)
+
+			if ((!this->m_bInitialized) || (!pFunction))
+				return false;
+
+			//Acquire calling context
+			asIScriptContext* pContext = this->AcquireContext();
+			if (!pContext)
+				return false;
+
+			//Prepare call stack and set object instance pointer if desired
+			if ((AS_FAILED(pContext->Prepare(pFunction))) || ((pClassInstance) && (AS_FAILED(pContext->SetObject(pClassInstance))))) {
+				this->ReleaseContext(pContext);
+				return false;
+			}
+
+			//Push arguments from left to right
+			asUINT uiArg = 0;
+			int aiArgResults[] = { 0, SetCallArg(pContext, uiArg++, args)... };
+			for (size_t i = 0; i < sizeof(aiArgResults) / sizeof(int); i++) {
+				if (AS_FAILED(aiArgResults[i])) {
+					this->ReleaseContext(pContext);
+					return false;
+				}
+			}
+
+			//Call function
+			if (!AS_EXECUTED(pContext->Execute())) {
+				this->ReleaseContext(pContext);
+				return false;
+			}
+
+			//Get return value if desired
+			if (pResult)
+				si_call_result_s<TResult>::Get(pContext, pResult);
+
+			this->ReleaseContext(pContext);
+
+			return true;
+		}
+
+		asIScriptFunction* GetScriptFunction(const HSISCRIPT hScript, const std::string& szFunctionName);
+
+		//Context pool size and statistics
+		void SetContextPoolSize(size_t uiSize);
+		inline size_t ContextsCreated(void) const { return this->m_uiContextsCreated; }
+		inline size_t ContextsReused(void) const { return this->m_uiContextsReused; }
+
+		//Script loading statistics
+		inline size_t ScriptsCompiled(void) const { return this->m_uiScriptsCompiled; }
+		inline size_t ScriptsFromCache(void) const { return this->m_uiScriptsFromCache; }
 	};
 }
 
@@ -27,6 +27,9 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <queue>
+#include <cmath>
 #include <fstream>
 #include <codecvt>
 #include <algorithm>
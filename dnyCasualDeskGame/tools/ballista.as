@@ -339,6 +339,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -808,6 +809,11 @@ class CBaseBallista : IScriptedEntity
 		if (!this.m_bMove)
 			return;
 
+		//Follow the flow field of the move order around obstacles
+		float flFlowAngle;
+		if (Ent_GetFlowDirection(this, this.m_vecPosition, flFlowAngle))
+			this.m_flBodyRot = flFlowAngle + 6.30 / 4;
+
 		//Set next position according to view
 		this.m_vecPosition[0] += int(sin(this.m_flBodyRot + 0.014) * this.m_sBallistaAttrs.Speed);
 		this.m_vecPosition[1] -= int(cos(this.m_flBodyRot + 0.014) * this.m_sBallistaAttrs.Speed);
@@ -343,6 +343,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -463,6 +464,7 @@ class CDecalEntity : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -469,6 +469,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -883,6 +884,11 @@ class CLaserMech : IScriptedEntity
 		if (!this.m_bMove)
 			return;
 
+		//Follow the flow field of the move order around obstacles
+		float flFlowAngle;
+		if (Ent_GetFlowDirection(this, this.m_vecPos, flFlowAngle))
+			this.m_fRotation = flFlowAngle + 6.30 / 4;
+
 		//Set next position according to view
 		this.m_vecPos[0] += int(sin(this.m_fRotation + 0.014) * this.m_fSpeed);
 		this.m_vecPos[1] -= int(cos(this.m_fRotation + 0.014) * this.m_fSpeed);
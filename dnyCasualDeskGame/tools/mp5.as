@@ -340,6 +340,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -460,6 +461,7 @@ class CDecalEntity : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
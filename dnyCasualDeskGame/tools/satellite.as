@@ -465,6 +465,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -815,6 +816,7 @@ class CLightning : IScriptedEntity
 }
 const int SATELLITE_ATTACK_DISTANCE = 250;
 const int SATELLITE_SPEED = 5;
+const uint SATELLITE_OFFSCREEN_REMOVE_DELAY = 3000;
 class CSatellite : IScriptedEntity
 {
 	Vector m_vecPos;
@@ -1029,6 +1031,7 @@ void CDG_API_Trigger(const Vector& in vAtPos)
 {
 	CSatellite @obj = CSatellite();
 	Ent_SpawnEntity(@obj, vAtPos);
+	Ent_SetLodPolicy(@obj, true, SATELLITE_OFFSCREEN_REMOVE_DELAY, 1);
 }
 
 /*
@@ -567,6 +567,11 @@ class CBaseSoldierEntity : IScriptedEntity
 		if (!this.m_bMove)
 			return;
 
+		//Follow the flow field of the move order around obstacles
+		float flFlowAngle;
+		if (Ent_GetFlowDirection(this, this.m_vecPos, flFlowAngle))
+			this.m_fRotation = flFlowAngle + 6.30 / 4;
+
 		this.m_vecPos[0] += int(sin(this.m_fRotation) * this.m_fSpeed);
 		this.m_vecPos[1] -= int(cos(this.m_fRotation) * this.m_fSpeed);
 		
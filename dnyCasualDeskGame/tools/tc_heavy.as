@@ -469,6 +469,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -671,6 +672,7 @@ class CDamageDecal : IScriptedEntity
 const int TANK_TEAM_1 = 1;
 const int TANK_TEAM_2 = 2;
 const int STOP_WALK_RANGE = 58;
+const uint IDLE_THINK_DELAY = 250;
 class TankAttributes
 {
 	int Health;
@@ -755,6 +757,11 @@ class CBaseTank : IScriptedEntity
 		if (!this.m_bMove)
 			return;
 
+		//Follow the flow field of the move order around obstacles
+		float flFlowAngle;
+		if (Ent_GetFlowDirection(this, this.m_vecPosition, flFlowAngle))
+			this.m_flBodyRot = flFlowAngle + 6.30 / 4;
+
 		//Set next position according to view
 		this.m_vecPosition[0] += int(sin(this.m_flBodyRot + 0.014) * this.m_sTankAttrs.Speed);
 		this.m_vecPosition[1] -= int(cos(this.m_flBodyRot + 0.014) * this.m_sTankAttrs.Speed);
@@ -939,6 +946,11 @@ class CBaseTank : IScriptedEntity
 		//Check for targets
 		this.CheckForTargets();
 		this.AttackTarget();
+		
+		//Sleep while idle and only look for targets now and then
+		if ((@this.m_pTarget == null) && (!this.m_bMove) && (!this.m_tmrDirMove.IsActive()) && (!this.m_tmrAiming.IsActive()) && (!this.m_tmrAttack.IsActive()) && (!this.m_tmrMuzzle.IsActive())) {
+			Ent_SetNextThink(this, IDLE_THINK_DELAY);
+		}
 	}
 	
 	//Entity can draw everything in default order here
@@ -998,6 +1010,9 @@ class CBaseTank : IScriptedEntity
 	void OnDamage(DamageValue dv)
 	{
 		this.m_sTankAttrs.Health -= dv;
+		
+		//Wake up to react and to be removed when destroyed
+		Ent_SetNextThink(this, 0);
 	}
 	
 	//Called for recieving the model data for this entity. This is only used for
@@ -1055,6 +1070,9 @@ class CBaseTank : IScriptedEntity
 
 		//Enable movement
 		this.m_bMove = true;
+		
+		//Wake up if idle
+		Ent_SetNextThink(this, 0);
 	}
 }
 class CHeavyTank : CBaseTank
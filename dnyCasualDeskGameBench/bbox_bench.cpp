@@ -0,0 +1,194 @@
+#include "bench.h"
+#include "entity.h"
+#include "models.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+#define BENCH_BBOX_PAIRS 4096
+#define BENCH_BBOX_PASSES 256
+
+class CLegacyBoundingBox { //Bounding box as it was before storing the items as columns, kept as reference
+private:
+	struct bbox_item_s {
+		Entity::Vector pos;
+		Entity::Vector size;
+	};
+
+	std::vector<bbox_item_s>* m_pvBBoxItems;
+
+	bool IsItemCollided(const Entity::Vector& vMyAbsPos, const Entity::Vector& vRefAbsPos, const bbox_item_s& rBBoxItem) const
+	{
+		//Check if bbox item collides with any of own items
+
+		if (!this->m_pvBBoxItems)
+			return false;
+
+		for (size_t i = 0; i < this->m_pvBBoxItems->size(); i++) { //Iterate through items
+			bbox_item_s item = (*this->m_pvBBoxItems)[i];
+			//Check if bbox item is inside current iterated item
+			if (((vRefAbsPos[0] + rBBoxItem.pos[0] >= vMyAbsPos[0] + (*this->m_pvBBoxItems)[i].pos[0]) && (vRefAbsPos[0] + rBBoxItem.pos[0] <= vMyAbsPos[0] + (*this->m_pvBBoxItems)[i].pos[0] + (*this->m_pvBBoxItems)[i].size[0])) && ((vRefAbsPos[1] + rBBoxItem.pos[1] >= vMyAbsPos[1] + (*this->m_pvBBoxItems)[i].pos[1]) && (vRefAbsPos[1] + rBBoxItem.pos[1] <= vMyAbsPos[1] + (*this->m_pvBBoxItems)[i].pos[1] + (*this->m_pvBBoxItems)[i].size[1]))) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+public:
+	CLegacyBoundingBox() : m_pvBBoxItems(nullptr) {}
+	~CLegacyBoundingBox() { delete this->m_pvBBoxItems; }
+
+	bool Alloc(void)
+	{
+		//Allocate memory for vector
+
+		this->m_pvBBoxItems = new std::vector<bbox_item_s>;
+
+		return this->m_pvBBoxItems != nullptr;
+	}
+
+	void AddBBoxItem(const Entity::Vector& pos, const Entity::Vector& size)
+	{
+		//Add bounding box item
+
+		bbox_item_s sItem;
+		sItem.pos = pos;
+		sItem.size = size;
+
+		this->m_pvBBoxItems->push_back(sItem);
+	}
+
+	bool IsCollided(const Entity::Vector& vMyAbsPos, const Entity::Vector& vRefAbsPos, const CLegacyBoundingBox& roBBox)
+	{
+		//Check if bounding boxes collide with each other
+
+		if (!this->m_pvBBoxItems)
+			return false;
+
+		if (roBBox.IsEmpty())
+			return false;
+
+		for (size_t i = 0; i < this->m_pvBBoxItems->size(); i++) { //Iterate through own bbox list
+			if (roBBox.IsItemCollided(vRefAbsPos, vMyAbsPos, (*this->m_pvBBoxItems)[i]))
+				return true;
+		}
+
+		return false;
+	}
+
+	inline bool IsEmpty(void) const { return (this->m_pvBBoxItems) ? (this->m_pvBBoxItems->size() == 0) : true; }
+};
+
+class CBBoxPairs { //Pairs of equal bounding boxes in both implementations together with the positions to test them at
+private:
+	std::vector<CLegacyBoundingBox> m_vLegacy;
+	std::vector<Entity::CBoundingBox> m_vCurrent;
+	std::vector<Entity::Vector> m_vPositions;
+	unsigned int m_uiSeed;
+
+	int Next(int iMin, int iMax)
+	{
+		//Get next value of a linear congruential generator in the given range
+
+		this->m_uiSeed = this->m_uiSeed * 1103515245u + 12345u;
+
+		return iMin + (int)((this->m_uiSeed >> 8) % (unsigned int)(iMax - iMin + 1));
+	}
+
+	void AddItem(size_t uiBox, int x, int y, int w, int h)
+	{
+		//Add the item to the box in both implementations
+
+		this->m_vLegacy[uiBox].AddBBoxItem(Entity::Vector(x, y), Entity::Vector(w, h));
+		this->m_vCurrent[uiBox].AddBBoxItem(Entity::Vector(x, y), Entity::Vector(w, h));
+	}
+public:
+	//Boxes either use the tool models or consist of the given amount of 16x16 items in rows of four.
+	//Near pairs are placed so that their enclosing rectangles overlap, far pairs so that they do not
+	CBBoxPairs(size_t uiItems, bool bNear, unsigned int uiSeed) : m_vLegacy(BENCH_BBOX_PAIRS * 2), m_vCurrent(BENCH_BBOX_PAIRS * 2), m_uiSeed(uiSeed)
+	{
+		for (size_t i = 0; i < BENCH_BBOX_PAIRS * 2; i++) {
+			this->m_vLegacy[i].Alloc();
+
+			if (!uiItems) {
+				const Bench::bbox_rect_s& rRect = Bench::asToolModels[this->Next(0, _countof(Bench::asToolModels) - 1)];
+				this->AddItem(i, rRect.x, rRect.y, rRect.w, rRect.h);
+			} else {
+				for (size_t k = 0; k < uiItems; k++) {
+					this->AddItem(i, (int)(k % 4) * 16, (int)(k / 4) * 16, 15, 15);
+				}
+			}
+
+			int iRange = (bNear) ? 64 : 4096;
+			this->m_vPositions.push_back(Entity::Vector(this->Next(0, iRange), this->Next(0, iRange)));
+		}
+
+		if (!bNear) {
+			//Move every second box out of reach of its partner
+			for (size_t i = 1; i < BENCH_BBOX_PAIRS * 2; i += 2) {
+				this->m_vPositions[i][0] = this->m_vPositions[i - 1][0] + 256 + this->Next(0, 256);
+			}
+		}
+	}
+
+	size_t RunLegacy(void)
+	{
+		//Test all pairs with the former implementation and count the hits
+
+		size_t uiHits = 0;
+
+		for (size_t i = 0; i < BENCH_BBOX_PAIRS * 2; i += 2) {
+			uiHits += this->m_vLegacy[i].IsCollided(this->m_vPositions[i], this->m_vPositions[i + 1], this->m_vLegacy[i + 1]);
+		}
+
+		return uiHits;
+	}
+
+	size_t RunCurrent(void)
+	{
+		//Test all pairs with the current implementation and count the hits
+
+		size_t uiHits = 0;
+
+		for (size_t i = 0; i < BENCH_BBOX_PAIRS * 2; i += 2) {
+			uiHits += this->m_vCurrent[i].IsCollided(this->m_vPositions[i], this->m_vPositions[i + 1], this->m_vCurrent[i + 1]);
+		}
+
+		return uiHits;
+	}
+};
+
+BENCH_SCENARIO(BBox_IsCollided)
+{
+	//Narrow phase bbox test of the former item list against the column layout, for the shipped single item models and larger item counts
+
+	static const size_t auiItems[] = { 0, 4, 8, 12 };
+
+	for (size_t c = 0; c < _countof(auiItems); c++) {
+		for (int n = 1; n >= 0; n--) {
+			CBBoxPairs oPairs(auiItems[c], n != 0, 1 + (unsigned int)c);
+
+			size_t uiLegacyHits = 0, uiCurrentHits = 0;
+
+			double dblLegacy = Bench::BestOf(BENCH_DEFAULT_RUNS, [&]() { for (size_t p = 0; p < BENCH_BBOX_PASSES; p++) { uiLegacyHits = oPairs.RunLegacy(); Bench::uiSink += uiLegacyHits; } });
+			double dblCurrent = Bench::BestOf(BENCH_DEFAULT_RUNS, [&]() { for (size_t p = 0; p < BENCH_BBOX_PASSES; p++) { uiCurrentHits = oPairs.RunCurrent(); Bench::uiSink += uiCurrentHits; } });
+
+			if (uiLegacyHits != uiCurrentHits)
+				std::cout << "  Mismatch: " << uiLegacyHits << " hits of legacy, " << uiCurrentHits << " hits of current" << std::endl;
+
+			std::string szCase = ((auiItems[c]) ? std::to_string(auiItems[c]) + " items" : std::string("tool models")) + ((n) ? ", near" : ", far");
+
+			Bench::Report(szCase + ", legacy", dblLegacy, BENCH_BBOX_PAIRS * BENCH_BBOX_PASSES);
+			Bench::Report(szCase + ", current (" + std::to_string(uiCurrentHits) + " hits)", dblCurrent, BENCH_BBOX_PAIRS * BENCH_BBOX_PASSES);
+		}
+	}
+}
@@ -0,0 +1,251 @@
+/*
+	Casual Desktop Game (dnycasualDeskGame) v1.0 developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Benchmark entities (developed by Daniel Brendel)
+	Version: 0.1
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+/*
+	Entities spawned by the benchmark scenarios. They do not load sprites or
+	sounds, so that they can be processed without renderer and sound.
+	All of them can be cleaned by the user, which is used to remove them
+	between the scenarios.
+*/
+
+uint g_uiSeed = 1;
+
+//Get next value of a linear congruential generator in the given range
+int NextRandom(int iMin, int iMax)
+{
+	g_uiSeed = g_uiSeed * 1103515245 + 12345;
+	return iMin + int((g_uiSeed >> 8) % uint(iMax - iMin + 1));
+}
+
+//Damageable entity that moves through the area, using the bounding box sizes of the tool models
+class CBenchUnit : IScriptedEntity
+{
+	Vector m_vecPos;
+	Vector m_vecDir;
+	Vector m_vecSize;
+	Model m_oModel;
+	int m_iSide;
+	int m_iHealth;
+
+	CBenchUnit(int iSide)
+	{
+		this.m_iSide = iSide;
+		this.m_iHealth = 100;
+	}
+
+	void OnSpawn(const Vector& in vec)
+	{
+		array<int> aiSizes = { 100, 64, 60, 44, 43, 32, 18, 72, 81, 128, 48, 80, 50, 10 };
+		int iSize = aiSizes[NextRandom(0, int(aiSizes.length()) - 1)];
+
+		this.m_vecPos = vec;
+		this.m_vecDir = Vector(NextRandom(-2, 2), NextRandom(-2, 2));
+		this.m_vecSize = Vector(iSize, iSize);
+		BoundingBox bbox;
+		bbox.Alloc();
+		bbox.AddBBoxItem(Vector(0, 0), this.m_vecSize);
+		this.m_oModel.Alloc();
+		this.m_oModel.Initialize2(bbox, 0);
+	}
+
+	void OnRelease()
+	{
+	}
+
+	//Move and bounce off the borders of the area
+	void OnProcess()
+	{
+		this.m_vecPos = this.m_vecPos + this.m_vecDir;
+
+		if ((this.m_vecPos[0] < 0) || (this.m_vecPos[0] > this.m_iSide)) {
+			this.m_vecDir[0] = -this.m_vecDir[0];
+		}
+
+		if ((this.m_vecPos[1] < 0) || (this.m_vecPos[1] > this.m_iSide)) {
+			this.m_vecDir[1] = -this.m_vecDir[1];
+		}
+	}
+
+	void OnDraw()
+	{
+	}
+
+	bool DoUserCleaning()
+	{
+		return true;
+	}
+
+	bool NeedsRemoval()
+	{
+		return false;
+	}
+
+	DamageType IsDamageable()
+	{
+		return DAMAGEABLE_ALL;
+	}
+
+	void OnDamage(DamageValue dv)
+	{
+		this.m_iHealth -= int(dv);
+	}
+
+	Model& GetModel()
+	{
+		return this.m_oModel;
+	}
+
+	Vector& GetPosition()
+	{
+		return this.m_vecPos;
+	}
+
+	float GetRotation()
+	{
+		return 0.0;
+	}
+
+	DamageValue GetDamageValue()
+	{
+		return 0;
+	}
+
+	string GetName()
+	{
+		return "bench_unit";
+	}
+
+	bool IsMovable()
+	{
+		return false;
+	}
+
+	Vector& GetSelectionSize()
+	{
+		return this.m_vecSize;
+	}
+
+	void MoveTo(const Vector& in vec)
+	{
+	}
+}
+
+//Decal entity that sleeps between its thinks, like the decals of the tools
+class CBenchDecal : IScriptedEntity
+{
+	Vector m_vecPos;
+	Model m_oModel;
+
+	CBenchDecal()
+	{
+	}
+
+	void OnSpawn(const Vector& in vec)
+	{
+		this.m_vecPos = vec;
+		this.m_oModel.Alloc();
+	}
+
+	void OnRelease()
+	{
+	}
+
+	void OnProcess()
+	{
+		Ent_SetNextThink(this, 1000);
+	}
+
+	void OnDraw()
+	{
+	}
+
+	bool DoUserCleaning()
+	{
+		return true;
+	}
+
+	bool NeedsRemoval()
+	{
+		return false;
+	}
+
+	DamageType IsDamageable()
+	{
+		return DAMAGEABLE_NO;
+	}
+
+	void OnDamage(DamageValue dv)
+	{
+	}
+
+	Model& GetModel()
+	{
+		return this.m_oModel;
+	}
+
+	Vector& GetPosition()
+	{
+		return this.m_vecPos;
+	}
+
+	float GetRotation()
+	{
+		return 0.0;
+	}
+
+	DamageValue GetDamageValue()
+	{
+		return 0;
+	}
+
+	string GetName()
+	{
+		return "bench_decal";
+	}
+
+	bool IsMovable()
+	{
+		return false;
+	}
+
+	Vector& GetSelectionSize()
+	{
+		return this.m_vecPos;
+	}
+
+	void MoveTo(const Vector& in vec)
+	{
+	}
+}
+
+//Spawn damageable units at reproducible positions inside a square area of the given side length
+void SpawnUnits(int iCount, int iSide)
+{
+	g_uiSeed = 1;
+
+	for (int i = 0; i < iCount; i++) {
+		CBenchUnit @unit = CBenchUnit(iSide);
+		Ent_SpawnEntity(unit, Vector(NextRandom(0, iSide), NextRandom(0, iSide)));
+	}
+}
+
+//Spawn decals at reproducible positions inside a square area of the given side length
+void SpawnDecals(int iCount, int iSide)
+{
+	g_uiSeed = 1;
+
+	for (int i = 0; i < iCount; i++) {
+		CBenchDecal @decal = CBenchDecal();
+		Ent_SpawnEntity(decal, Vector(NextRandom(0, iSide), NextRandom(0, iSide)));
+	}
+}
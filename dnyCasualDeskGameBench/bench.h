@@ -0,0 +1,74 @@
+#pragma once
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+#include "shared.h"
+#include <chrono>
+#include <iomanip>
+
+//Every measurement is repeated and the fastest run is reported, which filters out scheduling noise
+#define BENCH_DEFAULT_RUNS 5
+
+/* Benchmark environment. Scenarios register themselves and are run by main() */
+namespace Bench {
+	typedef void(*TpfnScenario)(void);
+
+	struct scenario_s {
+		const char* szName;
+		TpfnScenario pfnScenario;
+	};
+
+	std::vector<scenario_s>& Scenarios(void);
+	void Report(const std::string& szLabel, double dblMilliseconds, size_t uiOperations);
+
+	class CRegistrar { //Adds a scenario to the list when constructed
+	public:
+		CRegistrar(const char* szName, TpfnScenario pfnScenario)
+		{
+			scenario_s sScenario = { szName, pfnScenario };
+			Scenarios().push_back(sScenario);
+		}
+	};
+
+	class CStopwatch { //Measures the time since construction or the last restart
+	private:
+		std::chrono::steady_clock::time_point m_tStart;
+	public:
+		CStopwatch() { this->Restart(); }
+
+		void Restart(void) { this->m_tStart = std::chrono::steady_clock::now(); }
+		double Milliseconds(void) const { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->m_tStart).count(); }
+	};
+
+	template <typename TFunction> double BestOf(size_t uiRuns, TFunction fnRun)
+	{
+		//Run the function the given amount of times and get the fastest run in milliseconds
+
+		double dblBest = 0.0;
+
+		for (size_t i = 0; i < uiRuns; i++) {
+			CStopwatch oWatch;
+			fnRun();
+			double dblElapsed = oWatch.Milliseconds();
+
+			if ((i == 0) || (dblElapsed < dblBest))
+				dblBest = dblElapsed;
+		}
+
+		return dblBest;
+	}
+
+	extern volatile size_t uiSink; //Results are accumulated here so that the compiler can not drop the measured work
+}
+
+#define BENCH_SCENARIO(name) static void name(void); static Bench::CRegistrar name##_oRegistrar(#name, &name); static void name(void)
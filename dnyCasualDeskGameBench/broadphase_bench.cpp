@@ -0,0 +1,158 @@
+#include "bench.h"
+#include "entity.h"
+#include "models.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+//Each entity gets an area of this size on average, so the density stays the same for all entity counts
+#define BENCH_AREA_PER_ENTITY 144
+
+class CBenchWorld { //Entities with tool models placed at reproducible positions
+private:
+	std::vector<Entity::CModel> m_vModels;
+	std::vector<Entity::Vector> m_vPositions;
+	std::vector<Entity::Vector> m_vBoundsMin, m_vBoundsMax;
+	unsigned int m_uiSeed;
+
+	int Next(int iMin, int iMax)
+	{
+		//Get next value of a linear congruential generator in the given range
+
+		this->m_uiSeed = this->m_uiSeed * 1103515245u + 12345u;
+
+		return iMin + (int)((this->m_uiSeed >> 8) % (unsigned int)(iMax - iMin + 1));
+	}
+public:
+	CBenchWorld(size_t uiCount, unsigned int uiSeed) : m_vModels(uiCount), m_uiSeed(uiSeed)
+	{
+		int iSide = (int)std::sqrt((double)uiCount) * BENCH_AREA_PER_ENTITY;
+
+		for (size_t i = 0; i < uiCount; i++) {
+			const Bench::bbox_rect_s& rRect = Bench::asToolModels[i % _countof(Bench::asToolModels)];
+
+			Entity::CBoundingBox oBBox;
+			oBBox.Alloc();
+			oBBox.AddBBoxItem(Entity::Vector(rRect.x, rRect.y), Entity::Vector(rRect.w, rRect.h));
+			this->m_vModels[i].Initialize2(oBBox, GFX_INVALID_SPRITE_ID);
+
+			Entity::Vector vPos(this->Next(0, iSide), this->Next(0, iSide));
+			Entity::Vector vMin, vMax;
+			oBBox.GetBounds(vMin, vMax);
+
+			this->m_vPositions.push_back(vPos);
+			this->m_vBoundsMin.push_back(Entity::Vector(vPos[0] + vMin[0], vPos[1] + vMin[1]));
+			this->m_vBoundsMax.push_back(Entity::Vector(vPos[0] + vMax[0], vPos[1] + vMax[1]));
+		}
+	}
+
+	inline bool Collided(size_t i, size_t j) { return this->m_vModels[i].IsCollided(this->m_vPositions[i], this->m_vPositions[j], this->m_vModels[j]); }
+
+	inline const Entity::Vector& BoundsMin(size_t uiEntity) const { return this->m_vBoundsMin[uiEntity]; }
+	inline const Entity::Vector& BoundsMax(size_t uiEntity) const { return this->m_vBoundsMax[uiEntity]; }
+	inline size_t Count(void) const { return this->m_vModels.size(); }
+};
+
+static size_t AllPairs(CBenchWorld& rWorld)
+{
+	//Narrow phase test of every pair in both directions, as done before the broad phase existed
+
+	size_t uiHits = 0;
+
+	for (size_t i = 0; i < rWorld.Count(); i++) {
+		for (size_t j = i + 1; j < rWorld.Count(); j++) {
+			if ((rWorld.Collided(i, j)) || (rWorld.Collided(j, i)))
+				uiHits++;
+		}
+	}
+
+	return uiHits;
+}
+
+static size_t GridPairs(CBenchWorld& rWorld, Entity::CSpatialGrid& rGrid)
+{
+	//Same steps as CScriptedEntsMgr::ProcessCollisions: build the grid, query it per entity and reject candidates by their bounds in one batch
+
+	size_t uiHits = 0;
+	std::vector<size_t> vCandidates, vOverlapping;
+	std::vector<int> vBounds[4];
+
+	rGrid.Clear(rWorld.Count());
+	for (size_t i = 0; i < rWorld.Count(); i++) {
+		rGrid.Insert(i, rWorld.BoundsMin(i), rWorld.BoundsMax(i));
+	}
+
+	for (size_t i = 0; i < rWorld.Count(); i++) {
+		const Entity::Vector& vMin = rWorld.BoundsMin(i);
+		const Entity::Vector& vMax = rWorld.BoundsMax(i);
+
+		rGrid.Query(vMin, vMax, vCandidates);
+
+		for (size_t k = 0; k < 4; k++) {
+			vBounds[k].clear();
+		}
+
+		size_t uiKept = 0;
+		for (size_t k = 0; k < vCandidates.size(); k++) {
+			size_t j = vCandidates[k];
+			if (j <= i)
+				continue;
+
+			vCandidates[uiKept++] = j;
+			vBounds[0].push_back(rWorld.BoundsMin(j)[0]);
+			vBounds[1].push_back(rWorld.BoundsMin(j)[1]);
+			vBounds[2].push_back(rWorld.BoundsMax(j)[0]);
+			vBounds[3].push_back(rWorld.BoundsMax(j)[1]);
+		}
+
+		if (!uiKept)
+			continue;
+
+		RectKernels::rect_columns_s sRects = { vBounds[0].data(), vBounds[1].data(), vBounds[2].data(), vBounds[3].data(), uiKept };
+		vOverlapping.resize(uiKept);
+		size_t uiOverlapping = RectKernels::CollectOverlapping(sRects, vMin[0], vMin[1], vMax[0], vMax[1], vOverlapping.data());
+
+		for (size_t k = 0; k < uiOverlapping; k++) {
+			size_t j = vCandidates[vOverlapping[k]];
+
+			if ((rWorld.Collided(i, j)) || (rWorld.Collided(j, i)))
+				uiHits++;
+		}
+	}
+
+	return uiHits;
+}
+
+BENCH_SCENARIO(BroadPhase_Scaling)
+{
+	//Collision handling cost of one tick from 100 to 10,000 damageable entities. Script calls are not part of this, see Tick_Scaling
+
+	static const size_t auiCounts[] = { 100, 1000, 2500, 5000, 10000 };
+
+	for (size_t c = 0; c < _countof(auiCounts); c++) {
+		CBenchWorld oWorld(auiCounts[c], 1 + (unsigned int)c);
+		Entity::CSpatialGrid oGrid;
+
+		size_t uiAllHits = 0, uiGridHits = 0;
+
+		double dblAllPairs = Bench::BestOf(BENCH_DEFAULT_RUNS, [&]() { uiAllHits = AllPairs(oWorld); });
+		double dblGrid = Bench::BestOf(BENCH_DEFAULT_RUNS, [&]() { uiGridHits = GridPairs(oWorld, oGrid); });
+
+		if (uiAllHits != uiGridHits)
+			std::cout << "  Mismatch: " << uiAllHits << " hits of all pairs, " << uiGridHits << " hits of grid" << std::endl;
+
+		Bench::uiSink += uiAllHits + uiGridHits;
+
+		Bench::Report(std::to_string(auiCounts[c]) + " entities, all pairs", dblAllPairs, auiCounts[c]);
+		Bench::Report(std::to_string(auiCounts[c]) + " entities, grid (" + std::to_string(uiGridHits) + " hits)", dblGrid, auiCounts[c]);
+	}
+}
@@ -0,0 +1,55 @@
+#include "headless.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+//Ticks run before cleaning, so that all decals have thought once and are sleeping
+#define BENCH_DECAL_TICKS 2
+#define BENCH_AREA_PER_DECAL 16
+
+BENCH_SCENARIO(Clean_Decals)
+{
+	//Right-click clean of up to 20,000 sleeping decals in one call, including their script releases
+
+	Bench::CHeadless* pHeadless = Bench::Headless();
+	if (!pHeadless)
+		return;
+
+	static const int aiCounts[] = { 1000, 5000, 20000 };
+
+	for (size_t c = 0; c < _countof(aiCounts); c++) {
+		double dblBest = 0.0;
+
+		for (size_t r = 0; r < BENCH_DEFAULT_RUNS; r++) {
+			if (!pHeadless->Spawn("SpawnDecals", aiCounts[c], (int)std::sqrt((double)aiCounts[c]) * BENCH_AREA_PER_DECAL)) {
+				std::cout << "  Failed to spawn decals" << std::endl;
+				return;
+			}
+
+			for (size_t i = 0; i < BENCH_DECAL_TICKS; i++) {
+				Entity::oScriptedEntMgr.Process();
+			}
+
+			Bench::CStopwatch oWatch;
+			pHeadless->Clean();
+			double dblElapsed = oWatch.Milliseconds();
+
+			if (Entity::oScriptedEntMgr.GetEntityCount())
+				std::cout << "  " << Entity::oScriptedEntMgr.GetEntityCount() << " entities left after cleaning" << std::endl;
+
+			if ((r == 0) || (dblElapsed < dblBest))
+				dblBest = dblElapsed;
+		}
+
+		Bench::Report(std::to_string(aiCounts[c]) + " decals, one clean", dblBest, aiCounts[c]);
+	}
+}
@@ -0,0 +1,104 @@
+#include "headless.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+namespace Bench {
+	static void AS_MessageCallback(const asSMessageInfo* msg, void* param)
+	{
+		//Print AngelScript messages, e.g. compile errors of the benchmark script
+
+		std::cout << "  " << msg->section << " (" << msg->row << ", " << msg->col << "): " << msg->message << std::endl;
+	}
+
+	bool CHeadless::Initialize(void)
+	{
+		//Setup scripting and entity handling
+
+		if (this->m_pScriptInt)
+			return true;
+
+		this->m_pScriptInt = new Scripting::CScriptInt(".\\", (void*)&AS_MessageCallback);
+		if ((!this->m_pScriptInt) || (!this->m_pScriptInt->IsReady())) {
+			this->Shutdown();
+			return false;
+		}
+
+		this->m_pToolMgr = Entity::Initialize(nullptr, nullptr, this->m_pScriptInt, nullptr);
+		if (!this->m_pToolMgr) {
+			this->Shutdown();
+			return false;
+		}
+
+		this->m_hScript = this->m_pScriptInt->LoadScript(BENCH_SCRIPT_FILE);
+		if (this->m_hScript == SI_INVALID_ID) {
+			this->Shutdown();
+			return false;
+		}
+
+		return true;
+	}
+
+	void CHeadless::Shutdown(void)
+	{
+		//Remove all entities before their script objects are released together with the script engine
+
+		if (this->m_pToolMgr) {
+			Entity::oScriptedEntMgr.OnUserClean();
+
+			delete this->m_pToolMgr;
+			this->m_pToolMgr = nullptr;
+		}
+
+		if (this->m_pScriptInt) {
+			delete this->m_pScriptInt;
+			this->m_pScriptInt = nullptr;
+		}
+
+		this->m_hScript = SI_INVALID_ID;
+	}
+
+	bool CHeadless::Spawn(const std::string& szFunction, int iCount, int iSide)
+	{
+		//Call a spawn function of the benchmark script
+
+		asIScriptFunction* pFunction = this->m_pScriptInt->GetScriptFunction(this->m_hScript, szFunction);
+		if (!pFunction)
+			return false;
+
+		return this->m_pScriptInt->Call<void>(pFunction, nullptr, nullptr, iCount, iSide);
+	}
+
+	void CHeadless::Clean(void)
+	{
+		//Remove all entities, the benchmark entities allow user cleaning
+
+		Entity::oScriptedEntMgr.OnUserClean();
+	}
+
+	CHeadless* Headless(void)
+	{
+		//Get the environment, initialize it on first use. Scenarios are skipped if this fails
+
+		static CHeadless oHeadless;
+		static bool bTried = false;
+
+		if (!bTried) {
+			bTried = true;
+
+			if (!oHeadless.Initialize())
+				std::cout << "  Headless environment not available, " BENCH_SCRIPT_FILE " must be in the working directory" << std::endl;
+		}
+
+		return (oHeadless.ScriptInt()) ? &oHeadless : nullptr;
+	}
+}
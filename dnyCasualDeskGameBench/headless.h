@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+#include "bench.h"
+#include "scriptint.h"
+#include "entity.h"
+
+//Script with the benchmark entities, relative to the working directory
+#define BENCH_SCRIPT_FILE "bench.as"
+
+namespace Bench {
+	/* Script engine and entity manager without renderer and sound. Entities are spawned by the functions of the benchmark script */
+	class CHeadless {
+	private:
+		Scripting::CScriptInt* m_pScriptInt;
+		Entity::CToolMgr* m_pToolMgr;
+		Scripting::HSISCRIPT m_hScript;
+	public:
+		CHeadless() : m_pScriptInt(nullptr), m_pToolMgr(nullptr), m_hScript(SI_INVALID_ID) {}
+		~CHeadless() { this->Shutdown(); }
+
+		bool Initialize(void);
+		void Shutdown(void);
+
+		bool Spawn(const std::string& szFunction, int iCount, int iSide);
+		void Clean(void);
+
+		inline Scripting::CScriptInt* ScriptInt(void) { return this->m_pScriptInt; }
+	};
+
+	CHeadless* Headless(void);
+}
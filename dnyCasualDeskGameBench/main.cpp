@@ -0,0 +1,61 @@
+#include "bench.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+namespace Bench {
+	volatile size_t uiSink = 0;
+
+	std::vector<scenario_s>& Scenarios(void)
+	{
+		//Get list of registered scenarios
+
+		static std::vector<scenario_s> vScenarios;
+
+		return vScenarios;
+	}
+
+	void Report(const std::string& szLabel, double dblMilliseconds, size_t uiOperations)
+	{
+		//Print a measurement together with the time per operation
+
+		std::cout << "  " << std::left << std::setw(48) << szLabel << std::right << std::fixed << std::setprecision(3) << std::setw(12) << dblMilliseconds << " ms";
+
+		if (uiOperations)
+			std::cout << std::setw(12) << std::setprecision(1) << dblMilliseconds * 1000000.0 / (double)uiOperations << " ns/op";
+
+		std::cout << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	//Run all scenarios, or the ones whose name contains the first argument
+
+	size_t uiRun = 0;
+
+	for (size_t i = 0; i < Bench::Scenarios().size(); i++) {
+		const Bench::scenario_s& rScenario = Bench::Scenarios()[i];
+
+		if ((argc > 1) && (!strstr(rScenario.szName, argv[1])))
+			continue;
+
+		std::cout << "[ RUN ] " << rScenario.szName << std::endl;
+
+		rScenario.pfnScenario();
+		uiRun++;
+	}
+
+	std::cout << uiRun << " scenarios run" << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+namespace Bench {
+	struct bbox_rect_s {
+		int x, y, w, h;
+	};
+
+	//Bounding boxes of the models shipped with the tools, each of them consists of one item
+	static const bbox_rect_s asToolModels[] = {
+		{ 14, 14, 100, 100 }, { 0, 0, 64, 64 }, { 0, 0, 60, 99 }, { 0, 0, 59, 12 }, { 2, 16, 44, 44 }, { 0, 0, 43, 32 }, { 0, 0, 32, 32 },
+		{ 0, 0, 18, 18 }, { 0, 0, 72, 72 }, { 0, 0, 81, 55 }, { 0, 0, 128, 128 }, { 0, 0, 48, 48 }, { 0, 0, 80, 60 }, { 0, 0, 32, 55 },
+		{ 0, 0, 50, 50 }, { 0, 0, 10, 10 }
+	};
+}
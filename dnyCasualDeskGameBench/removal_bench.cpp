@@ -0,0 +1,179 @@
+#include "bench.h"
+#include "entity.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+class CRemovalList { //Entity list together with the snapshot columns and slot indices that move along with it on removal
+private:
+	struct bench_ent_s {
+		size_t uiId;
+		size_t uiHandle;
+	};
+
+	std::vector<bench_ent_s> m_vStorage;
+	std::vector<bench_ent_s*> m_vEnts;
+	std::vector<Entity::Vector> m_vPositions, m_vBoundsMin, m_vBoundsMax;
+	std::vector<void*> m_vModels;
+	std::vector<int> m_vDamageTypes;
+	std::vector<size_t> m_vNameIds;
+	std::vector<int> m_vDamageValues;
+	std::vector<size_t> m_vSlots;
+	std::vector<size_t> m_vPendingRemoval;
+
+	template <typename T> static void MoveRow(std::vector<T>& rColumn, size_t uiFrom, size_t uiTo) { rColumn[uiTo] = rColumn[uiFrom]; }
+	template <typename T> static void EraseRow(std::vector<T>& rColumn, size_t uiRow) { rColumn.erase(rColumn.begin() + uiRow); }
+public:
+	void Build(size_t uiCount)
+	{
+		//Fill the list with the given amount of entities
+
+		this->m_vStorage.resize(uiCount);
+		this->m_vEnts.clear();
+		this->m_vSlots.resize(uiCount);
+
+		for (size_t i = 0; i < uiCount; i++) {
+			this->m_vStorage[i].uiId = i;
+			this->m_vStorage[i].uiHandle = i;
+			this->m_vEnts.push_back(&this->m_vStorage[i]);
+			this->m_vSlots[i] = i;
+		}
+
+		this->m_vPositions.assign(uiCount, Entity::Vector(1, 2));
+		this->m_vBoundsMin.assign(uiCount, Entity::Vector(1, 2));
+		this->m_vBoundsMax.assign(uiCount, Entity::Vector(3, 4));
+		this->m_vModels.assign(uiCount, nullptr);
+		this->m_vDamageTypes.assign(uiCount, 0);
+		this->m_vNameIds.assign(uiCount, 0);
+		this->m_vDamageValues.assign(uiCount, 0);
+	}
+
+	void EraseInPlace(size_t uiStep)
+	{
+		//Former removal: erase every removed entity from the list and all columns, then update the slot indices of the following entities.
+		//The former loop also skipped the entity after a removed one, this one re-checks the same index so that both variants remove the same entities
+
+		for (size_t i = 0; i < this->m_vEnts.size(); ) {
+			if (this->m_vEnts[i]->uiId % uiStep) {
+				i++;
+				continue;
+			}
+
+			EraseRow(this->m_vEnts, i);
+			EraseRow(this->m_vPositions, i);
+			EraseRow(this->m_vBoundsMin, i);
+			EraseRow(this->m_vBoundsMax, i);
+			EraseRow(this->m_vModels, i);
+			EraseRow(this->m_vDamageTypes, i);
+			EraseRow(this->m_vNameIds, i);
+			EraseRow(this->m_vDamageValues, i);
+
+			for (size_t j = i; j < this->m_vEnts.size(); j++) {
+				this->m_vSlots[this->m_vEnts[j]->uiHandle] = j;
+			}
+		}
+	}
+
+	void Compact(size_t uiStep)
+	{
+		//Current removal: collect the removed entities and compact the list and all columns once, as CScriptedEntsMgr::RemovePending does
+
+		for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+			if (!(this->m_vEnts[i]->uiId % uiStep))
+				this->m_vPendingRemoval.push_back(i);
+		}
+
+		size_t uiPending = 0;
+		size_t uiKept = 0;
+
+		for (size_t i = 0; i < this->m_vEnts.size(); i++) {
+			if ((uiPending < this->m_vPendingRemoval.size()) && (this->m_vPendingRemoval[uiPending] == i)) {
+				uiPending++;
+				continue;
+			}
+
+			if (uiKept != i) {
+				this->m_vEnts[uiKept] = this->m_vEnts[i];
+				MoveRow(this->m_vPositions, i, uiKept);
+				MoveRow(this->m_vBoundsMin, i, uiKept);
+				MoveRow(this->m_vBoundsMax, i, uiKept);
+				MoveRow(this->m_vModels, i, uiKept);
+				MoveRow(this->m_vDamageTypes, i, uiKept);
+				MoveRow(this->m_vNameIds, i, uiKept);
+				MoveRow(this->m_vDamageValues, i, uiKept);
+				this->m_vSlots[this->m_vEnts[uiKept]->uiHandle] = uiKept;
+			}
+
+			uiKept++;
+		}
+
+		this->m_vEnts.resize(uiKept);
+		this->m_vPositions.resize(uiKept);
+		this->m_vBoundsMin.resize(uiKept);
+		this->m_vBoundsMax.resize(uiKept);
+		this->m_vModels.resize(uiKept);
+		this->m_vDamageTypes.resize(uiKept);
+		this->m_vNameIds.resize(uiKept);
+		this->m_vDamageValues.resize(uiKept);
+		this->m_vPendingRemoval.clear();
+	}
+
+	inline size_t Count(void) const { return this->m_vEnts.size(); }
+};
+
+template <typename TFunction> static double BestRemoval(CRemovalList& rList, size_t uiCount, TFunction fnRemove)
+{
+	//Get the fastest of the default amount of runs, the list is rebuilt before each run and that is not measured
+
+	double dblBest = 0.0;
+
+	for (size_t i = 0; i < BENCH_DEFAULT_RUNS; i++) {
+		rList.Build(uiCount);
+
+		Bench::CStopwatch oWatch;
+		fnRemove();
+		double dblElapsed = oWatch.Milliseconds();
+
+		if ((i == 0) || (dblElapsed < dblBest))
+			dblBest = dblElapsed;
+	}
+
+	Bench::uiSink += rList.Count();
+
+	return dblBest;
+}
+
+BENCH_SCENARIO(Removal_Compaction)
+{
+	//Removal of all or every second entity in one pass, erasing in place against the deferred compaction. Script calls are not part of this, see Clean_Decals
+
+	static const size_t auiCounts[] = { 1000, 5000, 20000 };
+	static const size_t auiSteps[] = { 1, 2 };
+
+	for (size_t c = 0; c < _countof(auiCounts); c++) {
+		for (size_t s = 0; s < _countof(auiSteps); s++) {
+			CRemovalList oList;
+
+			double dblErase = BestRemoval(oList, auiCounts[c], [&]() { oList.EraseInPlace(auiSteps[s]); });
+			size_t uiEraseLeft = oList.Count();
+			double dblCompact = BestRemoval(oList, auiCounts[c], [&]() { oList.Compact(auiSteps[s]); });
+
+			if (uiEraseLeft != oList.Count())
+				std::cout << "  Mismatch: " << uiEraseLeft << " entities left after erasing, " << oList.Count() << " after compaction" << std::endl;
+
+			std::string szCase = std::to_string(auiCounts[c]) + ((auiSteps[s] == 1) ? " entities, all removed" : " entities, every second removed");
+
+			Bench::Report(szCase + ", erase", dblErase, auiCounts[c]);
+			Bench::Report(szCase + ", compact", dblCompact, auiCounts[c]);
+		}
+	}
+}
@@ -0,0 +1,101 @@
+#include "headless.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+//Ticks run before measuring, e.g. so that contexts are pooled and containers have grown
+#define BENCH_WARMUP_TICKS 5
+#define BENCH_MEASURED_TICKS 20
+#define BENCH_AREA_PER_UNIT 144
+
+BENCH_SCENARIO(Tick_Scaling)
+{
+	//Full entity tick from 100 to 10,000 scripted units, including script calls, snapshot and collision handling
+
+	Bench::CHeadless* pHeadless = Bench::Headless();
+	if (!pHeadless)
+		return;
+
+	static const int aiCounts[] = { 100, 1000, 2500, 5000, 10000 };
+
+	for (size_t c = 0; c < _countof(aiCounts); c++) {
+		if (!pHeadless->Spawn("SpawnUnits", aiCounts[c], (int)std::sqrt((double)aiCounts[c]) * BENCH_AREA_PER_UNIT)) {
+			std::cout << "  Failed to spawn units" << std::endl;
+			break;
+		}
+
+		for (size_t i = 0; i < BENCH_WARMUP_TICKS; i++) {
+			Entity::oScriptedEntMgr.Process();
+		}
+
+		Bench::CStopwatch oWatch;
+		for (size_t i = 0; i < BENCH_MEASURED_TICKS; i++) {
+			Entity::oScriptedEntMgr.Process();
+		}
+		double dblPerTick = oWatch.Milliseconds() / BENCH_MEASURED_TICKS;
+
+		Bench::Report(std::to_string(aiCounts[c]) + " units, one tick", dblPerTick, aiCounts[c]);
+
+		pHeadless->Clean();
+	}
+}
+
+BENCH_SCENARIO(Tick_ContextPool)
+{
+	//Tick of 1,000 scripted units with the context pool against a new context for every script call, as done before pooling
+
+	Bench::CHeadless* pHeadless = Bench::Headless();
+	if (!pHeadless)
+		return;
+
+	static const size_t auiPoolSizes[] = { SI_CONTEXT_POOL_SIZE, 0 };
+	static const int iCount = 1000;
+	double adblPerTick[_countof(auiPoolSizes)] = { 0.0 };
+
+	for (size_t p = 0; p < _countof(auiPoolSizes); p++) {
+		pHeadless->ScriptInt()->SetContextPoolSize(auiPoolSizes[p]);
+
+		if (!pHeadless->Spawn("SpawnUnits", iCount, (int)std::sqrt((double)iCount) * BENCH_AREA_PER_UNIT)) {
+			std::cout << "  Failed to spawn units" << std::endl;
+			break;
+		}
+
+		for (size_t i = 0; i < BENCH_WARMUP_TICKS; i++) {
+			Entity::oScriptedEntMgr.Process();
+		}
+
+		size_t uiCreated = pHeadless->ScriptInt()->ContextsCreated();
+		size_t uiReused = pHeadless->ScriptInt()->ContextsReused();
+
+		//Fastest of several blocks of ticks, as a single block is easily disturbed by the allocator
+		adblPerTick[p] = Bench::BestOf(BENCH_DEFAULT_RUNS, [&]() {
+			for (size_t i = 0; i < BENCH_MEASURED_TICKS; i++) {
+				Entity::oScriptedEntMgr.Process();
+			}
+		}) / BENCH_MEASURED_TICKS;
+
+		uiCreated = (pHeadless->ScriptInt()->ContextsCreated() - uiCreated) / (BENCH_DEFAULT_RUNS * BENCH_MEASURED_TICKS);
+		uiReused = (pHeadless->ScriptInt()->ContextsReused() - uiReused) / (BENCH_DEFAULT_RUNS * BENCH_MEASURED_TICKS);
+
+		std::string szCase = (auiPoolSizes[p]) ? "pool of " + std::to_string(auiPoolSizes[p]) : std::string("no pool");
+
+		Bench::Report(szCase + ", one tick", adblPerTick[p], iCount);
+		std::cout << "  " << uiCreated << " contexts created, " << uiReused << " reused per tick" << std::endl;
+
+		pHeadless->Clean();
+	}
+
+	pHeadless->ScriptInt()->SetContextPoolSize(SI_CONTEXT_POOL_SIZE);
+
+	if ((adblPerTick[0] > 0.0) && (adblPerTick[1] > 0.0))
+		std::cout << "  Without the pool a tick takes " << std::fixed << std::setprecision(2) << adblPerTick[1] / adblPerTick[0] << " times as long" << std::endl;
+}
@@ -0,0 +1,65 @@
+#include "test.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+namespace Test {
+	static size_t uiFailedChecks = 0;
+
+	std::vector<test_case_s>& Cases(void)
+	{
+		//Get list of registered test cases
+
+		static std::vector<test_case_s> vCases;
+
+		return vCases;
+	}
+
+	void Fail(const char* szFile, int iLine, const char* szExpression)
+	{
+		//Report a failed check
+
+		std::cout << "  " << szFile << "(" << iLine << "): check failed: " << szExpression << std::endl;
+
+		uiFailedChecks++;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	//Run all test cases, or the ones whose name contains the first argument
+
+	size_t uiRun = 0, uiFailed = 0;
+
+	for (size_t i = 0; i < Test::Cases().size(); i++) {
+		const Test::test_case_s& rCase = Test::Cases()[i];
+
+		if ((argc > 1) && (!strstr(rCase.szName, argv[1])))
+			continue;
+
+		size_t uiFailedBefore = Test::uiFailedChecks;
+
+		rCase.pfnTest();
+		uiRun++;
+
+		if (Test::uiFailedChecks != uiFailedBefore) {
+			std::cout << "[FAIL] " << rCase.szName << std::endl;
+			uiFailed++;
+		} else {
+			std::cout << "[ OK ] " << rCase.szName << std::endl;
+		}
+	}
+
+	std::cout << uiRun - uiFailed << " of " << uiRun << " test cases passed" << std::endl;
+
+	return (uiFailed) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,212 @@
+#include "test.h"
+#include "rectkernels.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+//Coordinates span negative and positive values, queries go a bit beyond to cover points outside of all rectangles
+#define TEST_COORD_RANGE 24
+#define TEST_QUERY_RANGE (TEST_COORD_RANGE + 4)
+
+class CRectSet { //Rectangles stored as columns, filled with reproducible values
+private:
+	std::vector<int> m_vMinX, m_vMinY, m_vMaxX, m_vMaxY;
+	unsigned int m_uiSeed;
+
+	int Next(int iMin, int iMax)
+	{
+		//Get next value of a linear congruential generator in the given range
+
+		this->m_uiSeed = this->m_uiSeed * 1103515245u + 12345u;
+
+		return iMin + (int)((this->m_uiSeed >> 16) % (unsigned int)(iMax - iMin + 1));
+	}
+public:
+	CRectSet(size_t uiCount, unsigned int uiSeed) : m_uiSeed(uiSeed)
+	{
+		for (size_t i = 0; i < uiCount; i++) {
+			int x = this->Next(-TEST_COORD_RANGE, TEST_COORD_RANGE);
+			int y = this->Next(-TEST_COORD_RANGE, TEST_COORD_RANGE);
+
+			//Zero sizes give rectangles consisting of a single column, row or point
+			this->m_vMinX.push_back(x);
+			this->m_vMinY.push_back(y);
+			this->m_vMaxX.push_back(x + this->Next(0, 12));
+			this->m_vMaxY.push_back(y + this->Next(0, 12));
+		}
+	}
+
+	RectKernels::rect_columns_s Columns(void) const
+	{
+		RectKernels::rect_columns_s sRects = { this->m_vMinX.data(), this->m_vMinY.data(), this->m_vMaxX.data(), this->m_vMaxY.data(), this->m_vMinX.size() };
+		return sRects;
+	}
+
+	std::vector<int> Points(void) const
+	{
+		//Get the top left corners as interleaved points
+
+		std::vector<int> vPoints;
+		for (size_t i = 0; i < this->m_vMinX.size(); i++) {
+			vPoints.push_back(this->m_vMinX[i]);
+			vPoints.push_back(this->m_vMinY[i]);
+		}
+
+		return vPoints;
+	}
+
+	size_t Count(void) const { return this->m_vMinX.size(); }
+};
+
+static std::vector<RectKernels::KernelLevel> SupportedLevels(void)
+{
+	//Get all implementations that can run on this CPU
+
+	std::vector<RectKernels::KernelLevel> vLevels;
+	for (int i = RectKernels::KERNEL_SCALAR; i <= RectKernels::SupportedLevel(); i++) {
+		vLevels.push_back((RectKernels::KernelLevel)i);
+	}
+
+	return vLevels;
+}
+
+static const size_t auiCounts[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 33 }; //All tail lengths of 4 and 8 wide steps
+
+TEST_CASE(RectKernels_SelectsRequestedLevel)
+{
+	std::vector<RectKernels::KernelLevel> vLevels = SupportedLevels();
+
+	for (size_t i = 0; i < vLevels.size(); i++) {
+		RectKernels::SetLevel(vLevels[i]);
+		TEST_EQUAL(RectKernels::ActiveLevel(), vLevels[i]);
+	}
+
+	//Levels above the supported one are limited
+	RectKernels::SetLevel(RectKernels::KERNEL_AVX2);
+	TEST_EQUAL(RectKernels::ActiveLevel(), RectKernels::SupportedLevel());
+
+	std::cout << "  Testing kernels up to " << RectKernels::LevelName(RectKernels::SupportedLevel()) << std::endl;
+}
+
+TEST_CASE(RectKernels_AnyContainsPointMatchesScalar)
+{
+	std::vector<RectKernels::KernelLevel> vLevels = SupportedLevels();
+
+	for (size_t c = 0; c < _countof(auiCounts); c++) {
+		CRectSet oRects(auiCounts[c], 1 + (unsigned int)c);
+		RectKernels::rect_columns_s sRects = oRects.Columns();
+
+		//Every integer point of the area, so that all borders are hit exactly
+		for (int y = -TEST_QUERY_RANGE; y <= TEST_QUERY_RANGE + 12; y++) {
+			for (int x = -TEST_QUERY_RANGE; x <= TEST_QUERY_RANGE + 12; x++) {
+				bool bExpected = false;
+				for (size_t i = 0; i < sRects.uiCount; i++) {
+					bExpected |= (x >= sRects.piMinX[i]) && (x <= sRects.piMaxX[i]) && (y >= sRects.piMinY[i]) && (y <= sRects.piMaxY[i]);
+				}
+
+				for (size_t l = 0; l < vLevels.size(); l++) {
+					RectKernels::SetLevel(vLevels[l]);
+					TEST_EQUAL(RectKernels::AnyContainsPoint(sRects, x, y), bExpected);
+				}
+			}
+		}
+	}
+
+	RectKernels::SetLevel(RectKernels::SupportedLevel());
+}
+
+TEST_CASE(RectKernels_CollectOverlappingMatchesScalar)
+{
+	std::vector<RectKernels::KernelLevel> vLevels = SupportedLevels();
+
+	for (size_t c = 0; c < _countof(auiCounts); c++) {
+		CRectSet oRects(auiCounts[c], 100 + (unsigned int)c);
+		RectKernels::rect_columns_s sRects = oRects.Columns();
+
+		//Query with the rectangles of another set and with each rectangle itself, which touches it at all borders
+		CRectSet oQueries(64, 200 + (unsigned int)c);
+		RectKernels::rect_columns_s sQueries = oQueries.Columns();
+
+		for (size_t q = 0; q < sQueries.uiCount + sRects.uiCount; q++) {
+			const RectKernels::rect_columns_s& rSource = (q < sQueries.uiCount) ? sQueries : sRects;
+			size_t uiQuery = (q < sQueries.uiCount) ? q : q - sQueries.uiCount;
+
+			int iMinX = rSource.piMinX[uiQuery], iMinY = rSource.piMinY[uiQuery];
+			int iMaxX = rSource.piMaxX[uiQuery], iMaxY = rSource.piMaxY[uiQuery];
+
+			std::vector<size_t> vExpected;
+			for (size_t i = 0; i < sRects.uiCount; i++) {
+				if ((sRects.piMinX[i] <= iMaxX) && (iMinX <= sRects.piMaxX[i]) && (sRects.piMinY[i] <= iMaxY) && (iMinY <= sRects.piMaxY[i]))
+					vExpected.push_back(i);
+			}
+
+			for (size_t l = 0; l < vLevels.size(); l++) {
+				RectKernels::SetLevel(vLevels[l]);
+
+				std::vector<size_t> vFound(sRects.uiCount + 1);
+				vFound.resize(RectKernels::CollectOverlapping(sRects, iMinX, iMinY, iMaxX, iMaxY, vFound.data()));
+
+				TEST_CHECK(vFound == vExpected);
+			}
+		}
+	}
+
+	RectKernels::SetLevel(RectKernels::SupportedLevel());
+}
+
+TEST_CASE(RectKernels_CollectContainedMatchesScalar)
+{
+	std::vector<RectKernels::KernelLevel> vLevels = SupportedLevels();
+
+	for (size_t c = 0; c < _countof(auiCounts); c++) {
+		std::vector<int> vPoints = CRectSet(auiCounts[c], 300 + (unsigned int)c).Points();
+		size_t uiCount = auiCounts[c];
+
+		CRectSet oQueries(64, 400 + (unsigned int)c);
+		RectKernels::rect_columns_s sQueries = oQueries.Columns();
+
+		for (size_t q = 0; q <= sQueries.uiCount + uiCount; q++) {
+			int iMinX, iMinY, iMaxX, iMaxY;
+
+			if (q < sQueries.uiCount) {
+				iMinX = sQueries.piMinX[q]; iMinY = sQueries.piMinY[q];
+				iMaxX = sQueries.piMaxX[q]; iMaxY = sQueries.piMaxY[q];
+			} else if (q < sQueries.uiCount + uiCount) {
+				//Rectangle consisting of exactly one of the points
+				iMinX = iMaxX = vPoints[(q - sQueries.uiCount) * 2];
+				iMinY = iMaxY = vPoints[(q - sQueries.uiCount) * 2 + 1];
+			} else {
+				//Whole area, all points are inside
+				iMinX = iMinY = -TEST_QUERY_RANGE;
+				iMaxX = iMaxY = TEST_QUERY_RANGE;
+			}
+
+			std::vector<size_t> vExpected;
+			for (size_t i = 0; i < uiCount; i++) {
+				int x = vPoints[i * 2], y = vPoints[i * 2 + 1];
+				if ((x >= iMinX) && (x <= iMaxX) && (y >= iMinY) && (y <= iMaxY))
+					vExpected.push_back(i);
+			}
+
+			for (size_t l = 0; l < vLevels.size(); l++) {
+				RectKernels::SetLevel(vLevels[l]);
+
+				std::vector<size_t> vFound(uiCount + 1);
+				vFound.resize(RectKernels::CollectContained(vPoints.data(), uiCount, iMinX, iMinY, iMaxX, iMaxY, vFound.data()));
+
+				TEST_CHECK(vFound == vExpected);
+			}
+		}
+	}
+
+	RectKernels::SetLevel(RectKernels::SupportedLevel());
+}
@@ -0,0 +1,136 @@
+#include "test.h"
+#include "scheduler.h"
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+//A tick rate of 64 keeps the step time exact in binary floating point
+#define TEST_TICK_RATE 64
+#define TEST_STEP (1.0 / TEST_TICK_RATE)
+#define TEST_EPSILON 1e-9
+
+class CFakeClock : public Scheduler::IClock { //Clock that only moves when told to
+private:
+	double m_dblNow;
+public:
+	CFakeClock() : m_dblNow(100.0) {}
+	virtual ~CFakeClock() {}
+
+	virtual double Now(void) { return this->m_dblNow; }
+
+	void Advance(double dblSeconds) { this->m_dblNow += dblSeconds; }
+};
+
+TEST_CASE(Scheduler_StepsFollowElapsedTime)
+{
+	CFakeClock oClock;
+	Scheduler::CFixedStepScheduler oScheduler(&oClock, TEST_TICK_RATE);
+
+	TEST_EQUAL(oScheduler.Advance(), 0);
+
+	oClock.Advance(TEST_STEP);
+	TEST_EQUAL(oScheduler.Advance(), 1);
+
+	oClock.Advance(TEST_STEP * 3);
+	TEST_EQUAL(oScheduler.Advance(), 3);
+
+	oClock.Advance(TEST_STEP * 0.5);
+	TEST_EQUAL(oScheduler.Advance(), 0);
+
+	oClock.Advance(TEST_STEP * 0.5);
+	TEST_EQUAL(oScheduler.Advance(), 1);
+
+	TEST_EQUAL(oScheduler.TickCount(), 5);
+}
+
+TEST_CASE(Scheduler_ClampsStepsPerFrame)
+{
+	CFakeClock oClock;
+	Scheduler::CFixedStepScheduler oScheduler(&oClock, TEST_TICK_RATE);
+
+	//A long stall runs the maximum amount of steps and drops the rest of the time
+	oClock.Advance(1.0);
+	TEST_EQUAL(oScheduler.Advance(), SCHED_MAX_STEPS_PER_FRAME);
+	TEST_NEAR(oScheduler.Alpha(), 0.0, TEST_EPSILON);
+
+	TEST_EQUAL(oScheduler.Advance(), 0);
+
+	oScheduler.SetMaxStepsPerFrame(2);
+	oClock.Advance(TEST_STEP * 10);
+	TEST_EQUAL(oScheduler.Advance(), 2);
+
+	TEST_EQUAL(oScheduler.TickCount(), SCHED_MAX_STEPS_PER_FRAME + 2);
+}
+
+TEST_CASE(Scheduler_AlphaIsFractionOfNextStep)
+{
+	CFakeClock oClock;
+	Scheduler::CFixedStepScheduler oScheduler(&oClock, TEST_TICK_RATE);
+
+	oClock.Advance(TEST_STEP * 2.25);
+	TEST_EQUAL(oScheduler.Advance(), 2);
+	TEST_NEAR(oScheduler.Alpha(), 0.25, TEST_EPSILON);
+	TEST_NEAR(oScheduler.TimeToNextStep(), TEST_STEP * 0.75, TEST_EPSILON);
+
+	oClock.Advance(TEST_STEP * 0.5);
+	TEST_EQUAL(oScheduler.Advance(), 0);
+	TEST_NEAR(oScheduler.Alpha(), 0.75, TEST_EPSILON);
+
+	oClock.Advance(TEST_STEP * 0.25);
+	TEST_EQUAL(oScheduler.Advance(), 1);
+	TEST_NEAR(oScheduler.Alpha(), 0.0, TEST_EPSILON);
+}
+
+TEST_CASE(Scheduler_IgnoresClockGoingBackwards)
+{
+	CFakeClock oClock;
+	Scheduler::CFixedStepScheduler oScheduler(&oClock, TEST_TICK_RATE);
+
+	oClock.Advance(TEST_STEP * 0.5);
+	TEST_EQUAL(oScheduler.Advance(), 0);
+
+	oClock.Advance(-TEST_STEP * 4);
+	TEST_EQUAL(oScheduler.Advance(), 0);
+	TEST_NEAR(oScheduler.Alpha(), 0.5, TEST_EPSILON);
+
+	oClock.Advance(TEST_STEP * 0.5);
+	TEST_EQUAL(oScheduler.Advance(), 1);
+}
+
+TEST_CASE(Scheduler_ResetDropsAccumulatedTime)
+{
+	CFakeClock oClock;
+	Scheduler::CFixedStepScheduler oScheduler(&oClock, TEST_TICK_RATE);
+
+	oClock.Advance(TEST_STEP * 0.75);
+	TEST_EQUAL(oScheduler.Advance(), 0);
+
+	oClock.Advance(TEST_STEP * 3);
+	oScheduler.Reset();
+	TEST_NEAR(oScheduler.Alpha(), 0.0, TEST_EPSILON);
+
+	oClock.Advance(TEST_STEP * 0.5);
+	TEST_EQUAL(oScheduler.Advance(), 0);
+	TEST_NEAR(oScheduler.Alpha(), 0.5, TEST_EPSILON);
+}
+
+TEST_CASE(Scheduler_WithoutClockDoesNotStep)
+{
+	Scheduler::CFixedStepScheduler oScheduler;
+
+	TEST_EQUAL(oScheduler.Advance(), 0);
+	TEST_EQUAL(oScheduler.TickCount(), 0);
+
+	//Invalid settings are ignored
+	oScheduler.SetTickRate(0);
+	TEST_NEAR(oScheduler.StepTime(), 1.0 / SCHED_DEFAULT_TICK_RATE, TEST_EPSILON);
+}
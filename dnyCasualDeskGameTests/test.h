@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+	Casual Desktop Game (dnyCasualDeskGame) developed by Daniel Brendel
+
+	(C) 2018 - 2021 by Daniel Brendel
+
+	Version: 1.0
+	Contact: dbrendel1988<at>gmail<dot>com
+	GitHub: https://github.com/danielbrendel/
+
+	Released under the MIT license
+*/
+
+#include "shared.h"
+
+/* Headless test environment. Test cases register themselves and are run by main() */
+namespace Test {
+	typedef void(*TpfnTestCase)(void);
+
+	struct test_case_s {
+		const char* szName;
+		TpfnTestCase pfnTest;
+	};
+
+	std::vector<test_case_s>& Cases(void);
+	void Fail(const char* szFile, int iLine, const char* szExpression);
+
+	class CRegistrar { //Adds a test case to the list when constructed
+	public:
+		CRegistrar(const char* szName, TpfnTestCase pfnTest)
+		{
+			test_case_s sCase = { szName, pfnTest };
+			Cases().push_back(sCase);
+		}
+	};
+}
+
+#define TEST_CASE(name) static void name(void); static Test::CRegistrar name##_oRegistrar(#name, &name); static void name(void)
+#define TEST_CHECK(expr) if (!(expr)) { Test::Fail(__FILE__, __LINE__, #expr); }
+#define TEST_EQUAL(a, b) TEST_CHECK((a) == (b))
+#define TEST_NEAR(a, b, eps) TEST_CHECK(std::fabs((double)(a) - (double)(b)) <= (eps))
@@ -649,6 +649,7 @@ class CMissile : IScriptedEntity
 }
 const int AC_TEAM_1 = 1;
 const int AC_TEAM_2 = 2;
+const uint AC_OFFSCREEN_REMOVE_DELAY = 3000;
 class color_s
 {
 	uint8 r, g, b, a;
@@ -733,6 +734,7 @@ class CAircraft : IScriptedEntity
 		missile.SetTarget(@pEntity);
 		missile.SetRotation(this.m_fRotation);
 		Ent_SpawnEntity(@missile, this.m_vecPos);
+		Ent_SetLodPolicy(@missile, true, AC_OFFSCREEN_REMOVE_DELAY, 1);
 		
 		S_PlaySound(this.m_hFire, 8);
 	}
@@ -971,6 +973,7 @@ void CDG_API_Trigger(const Vector& in vAtPos)
 	CAircraft @obj = CAircraft();
 	obj.SetTeam((g_bTeamSelection) ? AC_TEAM_1 : AC_TEAM_2);
 	Ent_SpawnEntity(@obj, vAtPos);
+	Ent_SetLodPolicy(@obj, true, AC_OFFSCREEN_REMOVE_DELAY, 1);
 }
 
 /*
@@ -338,6 +338,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -419,18 +420,23 @@ class CDecalSprite : IScriptedEntity
 	{
 	}
 }
+const int EXPLOSION_SIZE = 256;
+const DamageValue EXPLOSION_DAMAGE = 64;
+const float EXPLOSION_FALLOFF = 0.5;
 class CExplosion : IScriptedEntity
 {
 	Vector m_vecPos;
 	Model m_oModel;
 	Timer m_oExplosion;
 	int m_iFrameCount;
+	bool m_bDetonated;
 	SpriteHandle m_hSprite;
 	SoundHandle m_hSound;
 	
 	CExplosion()
     {
 		this.m_iFrameCount = 0;
+		this.m_bDetonated = false;
     }
 	
 	//Called when the entity gets spawned. The position on the screen is passed as argument
@@ -443,11 +449,7 @@ class CExplosion : IScriptedEntity
 		this.m_oExplosion.SetActive(true);
 		this.m_hSound = S_QuerySound(g_szToolPath + "explosion.wav");
 		S_PlaySound(this.m_hSound, 10);
-		BoundingBox bbox;
-		bbox.Alloc();
-		bbox.AddBBoxItem(Vector(0, 0), Vector(256, 256));
 		this.m_oModel.Alloc();
-		this.m_oModel.Initialize2(bbox, this.m_hSprite);
 	}
 	
 	//Called when the entity gets released
@@ -458,6 +460,12 @@ class CExplosion : IScriptedEntity
 	//Process entity stuff
 	void OnProcess()
 	{
+		//Damage everything in reach once. The explosion itself does not collide with anything
+		if (!this.m_bDetonated) {
+			Ent_ApplyRadialDamage(Vector(this.m_vecPos[0] + EXPLOSION_SIZE / 2, this.m_vecPos[1] + EXPLOSION_SIZE / 2), EXPLOSION_SIZE / 2, EXPLOSION_DAMAGE, EXPLOSION_FALLOFF, "Bazooka", false);
+			this.m_bDetonated = true;
+		}
+		
 		this.m_oExplosion.Update();
 		if (this.m_oExplosion.IsElapsed()) {
 			this.m_oExplosion.Reset();
@@ -493,7 +501,7 @@ class CExplosion : IScriptedEntity
 	//0 = not damageable, 1 = damage all, 2 = not damaging entities with same name
 	DamageType IsDamageable()
 	{
-		return DAMAGEABLE_NOTSQUAD;
+		return DAMAGEABLE_NO;
 	}
 	
 	//Called when the entity recieves damage
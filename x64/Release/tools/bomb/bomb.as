@@ -335,6 +335,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -546,11 +547,13 @@ class CExplosion : IScriptedEntity
 	{
 	}
 }
+const int BOMB_FRAME_COUNT = 14;
+const uint BOMB_FRAME_DELAY = 100;
 class CBomb : IScriptedEntity
 {
 	Vector m_vecPos;
 	Model m_oModel;
-	Timer m_oExplosion;
+	bool m_bFuseLit;
 	int m_iFrameCount;
 	SpriteHandle m_hSprite;
 	SoundHandle m_hSound;
@@ -558,6 +561,7 @@ class CBomb : IScriptedEntity
 	CBomb()
     {
 		this.m_iFrameCount = 0;
+		this.m_bFuseLit = false;
     }
 	
 	//Called when the entity gets spawned. The position on the screen is passed as argument
@@ -565,9 +569,6 @@ class CBomb : IScriptedEntity
 	{
 		this.m_vecPos = vec;
 		this.m_hSprite = R_LoadSprite(g_szToolPath + "bomb.png", 14, 32, 32, 7, false);
-		this.m_oExplosion.SetDelay(100);
-		this.m_oExplosion.Reset();
-		this.m_oExplosion.SetActive(true);
 		this.m_hSound = S_QuerySound(g_szToolPath + "fuse.wav");
 		S_PlaySound(this.m_hSound, 10);
 		this.m_oModel.Alloc();
@@ -585,11 +586,14 @@ class CBomb : IScriptedEntity
 	//Process entity stuff
 	void OnProcess()
 	{
-		this.m_oExplosion.Update();
-		if (this.m_oExplosion.IsElapsed()) {
-			this.m_oExplosion.Reset();
+		//Advance the fuse by one frame and sleep until the next one. The first call only starts the delay
+		if (this.m_bFuseLit)
 			this.m_iFrameCount++;
-		}
+		
+		this.m_bFuseLit = true;
+		
+		if (this.m_iFrameCount < BOMB_FRAME_COUNT)
+			Ent_SetNextThink(this, BOMB_FRAME_DELAY);
 	}
 	
 	//Entity can draw everything in default order here
@@ -607,7 +611,7 @@ class CBomb : IScriptedEntity
 	//Indicate whether this entity shall be removed by the game
 	bool NeedsRemoval()
 	{
-		return this.m_iFrameCount >= 14;
+		return this.m_iFrameCount >= BOMB_FRAME_COUNT;
 	}
 	
 	//Indicate whether this entity is damageable. Damageable entities can collide with other
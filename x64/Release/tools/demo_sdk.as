@@ -29,6 +29,10 @@
 		- DAMAGEABLE_NO: Specifies a non-damageable entity
 		- DAMAGEABLE_ALL: Specifies an entity that can be damaged by all
 		- DAMAGEABLE_NOTSQUAD: Specifies an entity that cannot be damaged by entities with the same name
+	ContactPhase:
+		- CONTACT_BEGIN: The entities started to collide in this tick
+		- CONTACT_STAY: The entities collided in the previous tick and still collide
+		- CONTACT_END: The entities collided in the previous tick but not anymore
 	FileSeekWay:
 		- SEEKW_BEGIN: Start from the begin of a file
 		- SEEKW_CURRENT: Start from current file offset
@@ -61,6 +65,12 @@
 		- int vkTakeScreen //Virtual key code of the button to take screenshots
 		- int vkKey0 - vkKey9 //Virtual key code of a bound tool
 		- int vkExit //Virtual key code of the exit button
+	EntityPoolStats:
+		- size_t uiLive //Amount of entity records currently in use
+		- size_t uiPeak //Highest amount of entity records in use at the same time
+		- size_t uiCapacity //Amount of entity records the pool can hold without allocating memory
+		- size_t uiAllocations //Total amount of entity records handed out
+		- size_t uiHeapAllocations //Amount of memory blocks allocated by the pool
 		
 	Classes:
 	--------
@@ -137,6 +147,9 @@
 		- SpriteHandle Handle() //Returns the handle to the loaded sprite associated with the model
 		- const Vector& GetCenter() const //Getter for the center of the model
 		- BoundingBox& GetBBox() //Returns the associated bounding box
+		- bool EnablePixelCollision(uint8 alphaThreshold, int scale) //Refine collisions by masks built from the sprite alpha channel. Pixels with alpha >= alphaThreshold are solid, scale must match the integer draw scale. The bbox is still tested first
+		- void DisablePixelCollision() //Use only the bounding box for collisions again
+		- void SetFrame(int iFrame) //Set the sprite frame that is used for pixel collision. Call this when changing the drawn frame
 	Timer (Useful for processing stuff after a period of time):
 		- Timer() //Default constructor
 		- Timer(uint32 delay) //Construct with a given delay value. Also sets the timer in active state
@@ -198,6 +211,9 @@
 			DamageType IsDamageable()
 			//Called when the entity recieves damage
 			void OnDamage(DamageValue dv)
+			//Optional: Called when a collision with another damageable entity begins, stays or ends. The other
+			//entity is null if it has been removed in the meantime. Damage is still reported via OnDamage once per tick
+			void OnContact(IScriptedEntity@ pOther, ContactPhase ePhase)
 			//Called for recieving the model data for this entity. This is only used for
 			//damageable entities. 
 			Model& GetModel()
@@ -268,6 +284,39 @@
 	//Perform a trace line calculation from one point to another. The first found entity inside the trace line is returned.
 		You can specify an entity that shall be skipped by the search
 	IScriptedEntity@+ Ent_TraceLine(const Vector&in vStart, const Vector&in vEnd, IScriptedEntity@+ pIgnoredEnt)
+	//Same as Ent_TraceLine. Additionally returns the distance from the start position to the hit position of the found entity (-1 if none was found)
+	IScriptedEntity@+ Ent_TraceLineEx(const Vector&in vStart, const Vector&in vEnd, IScriptedEntity@+ pIgnoredEnt, int &out iDistance)
+	//Get all entities positioned inside the given radius around the origin. You can limit the search to damageable entities,
+		exclude entities with the given name (pass an empty string to not exclude any) and specify an entity that shall be skipped
+	array<IScriptedEntity@>@ Ent_QueryRadius(const Vector&in vOrigin, int iRadius, bool bDamageableOnly, const string&in szExcludeName, IScriptedEntity@+ pIgnoredEnt)
+	//Same as Ent_QueryRadius but for entities positioned inside the given rectangle
+	array<IScriptedEntity@>@ Ent_QueryBox(const Vector&in vMin, const Vector&in vMax, bool bDamageableOnly, const string&in szExcludeName, IScriptedEntity@+ pIgnoredEnt)
+	//Damage all damageable entities whose bounds reach into the circle, excluding entities with the given name (pass an empty string to not exclude any). The bounds are the model bounding box or, for movable entities without one, the selection size. Other entities count with their position. The damage decreases linearly towards the border by the falloff fraction (0.0 = full damage everywhere, 1.0 = no damage at the border), measured to the closest point of the bounds. Victims are found via the spatial index and informed via OnDamage() after all of them have been gathered. Returns the damaged entities if bReturnVictims is true, otherwise null
+	array<IScriptedEntity@>@ Ent_ApplyRadialDamage(const Vector&in vCenter, int iRadius, DamageValue dvDamage, float flFalloff, const string&in szExcludeName, bool bReturnVictims)
+	//Get the entity positioned nearest to the origin within the given range (zero or less for unlimited range). You can exclude
+		entities with the given name (pass an empty string to not exclude any) and limit the search to damageable entities
+	IScriptedEntity@+ Ent_FindNearest(const Vector&in vOrigin, int iMaxRange, const string&in szExcludeName, bool bDamageableOnly)
+	//Same as Ent_FindNearest but returns up to the given amount of entities ordered by distance
+	array<IScriptedEntity@>@ Ent_FindNearestK(const Vector&in vOrigin, int iMaxRange, const string&in szExcludeName, bool bDamageableOnly, uint uiCount)
+	//Get allocation counters of the engine entity pool. The size of the pool can be configured via entity_budget in res/engine.txt
+	void Ent_GetPoolStats(EntityPoolStats &out)
+	//Get the fraction of the next simulation tick that has already elapsed (0.0 - 1.0). Can be used in OnDraw to interpolate
+		between the previous and the current position of an entity
+	float Ent_GetInterpolationAlpha()
+	//Set collision layers of a spawned entity. Two entities only collide if the category of each one is contained in the mask of the other one.
+		Default category is 0x00000001 and default mask is 0xFFFFFFFF. Squads of DAMAGEABLE_NOTSQUAD entities are kept apart by separate engine layers, so all 32 bits are free for scripts. Call it right after Ent_SpawnEntity(). Returns false if the entity is not spawned
+	bool Ent_SetCollisionLayers(IScriptedEntity@ pEntity, uint32 uiCategory, uint32 uiMask)
+	//Get all entities with the given name. The name of an entity is resolved once when it is spawned
+	array<IScriptedEntity@>@ Ent_GetEntitiesByName(const string&in szName)
+	//Get amount of entities with the given name
+	uint Ent_CountByName(const string&in szName)
+	//Get the steering angle (radians, as with atan2) for an entity that received a group move order. A flow field is built once per order around immovable entities
+		and each unit is sent to its own formation slot via MoveTo(). The angle leads to the slot of the unit and points straight to it when near. Returns false if the entity has no move order
+	bool Ent_GetFlowDirection(IScriptedEntity@ pEntity, const Vector&in vPos, float &out flAngle)
+	//Let an entity sleep for the given time in milliseconds. The time is counted in simulation steps, rounded up to whole steps. OnProcess() is not called until then, so entities that wait for a timer do not cost anything meanwhile. It is still drawn and collides, using the attributes it had when it fell asleep. NeedsRemoval() is not called until it wakes up. Passing 0 wakes the entity up again. Returns false if the entity is not spawned
+	bool Ent_SetNextThink(IScriptedEntity@ pEntity, uint32 uiMilliseconds)
+	//Set the level of detail policy of a spawned entity. By default every entity is drawn and processed on every tick. Pass true to skip drawing it while its bounds are outside the screen. Only use this if everything the entity draws is within its model bounds, selection size or 128 pixels around its position. Entities that do not need to move or act every tick off-screen can pass a uiProcessInterval greater than 1 to have OnProcess() called only every n-th tick meanwhile. Pass 1 to process them every tick. If bEnabled is true and uiRemoveDelay is not 0 the entity is removed after it has been far outside the screen (more than 512 pixels) for the given milliseconds. Returns false if the entity is not spawned
+	bool Ent_SetLodPolicy(IScriptedEntity@ pEntity, bool bEnabled, uint32 uiRemoveDelay, uint32 uiProcessInterval)
 	//Check if an entity is still valid. This is useful for validating if an entity has not yet been disposed
 	bool Ent_IsValid(IScriptedEntity@ pEntity)
 	//Get the ID of an entity by the entity handle
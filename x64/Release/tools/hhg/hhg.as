@@ -335,6 +335,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -546,6 +547,7 @@ class CExplosion : IScriptedEntity
 	{
 	}
 }
+const uint HHG_STEP_DELAY = 50;
 class CHolyHandgrenade : IScriptedEntity
 {
 	Vector m_vecPos;
@@ -553,14 +555,14 @@ class CHolyHandgrenade : IScriptedEntity
 	SpriteHandle m_hSprite;
 	int m_ucAlpha;
 	Timer m_tmrAlive;
-	Timer m_tmrAlpha;
-	Timer m_tmrRot;
+	bool m_bStarted;
 	float m_fRotation;
 	
 	CHolyHandgrenade()
     {
 		this.m_ucAlpha = 255;
 		this.m_fRotation = 0.0;
+		this.m_bStarted = false;
     }
 	
 	//Called when the entity gets spawned. The position on the screen is passed as argument
@@ -571,12 +573,6 @@ class CHolyHandgrenade : IScriptedEntity
 		this.m_tmrAlive.SetDelay(2100);
 		this.m_tmrAlive.Reset();
 		this.m_tmrAlive.SetActive(true);
-		this.m_tmrAlpha.SetDelay(50);
-		this.m_tmrAlpha.Reset();
-		this.m_tmrAlpha.SetActive(true);
-		this.m_tmrRot.SetDelay(50);
-		this.m_tmrRot.Reset();
-		this.m_tmrRot.SetActive(true);
 		SoundHandle hHallelujah = S_QuerySound(g_szToolPath + "hallelujah.wav");
 		S_PlaySound(hHallelujah, 10);
 		this.m_oModel.Alloc();
@@ -597,28 +593,21 @@ class CHolyHandgrenade : IScriptedEntity
 	//Process entity stuff
 	void OnProcess()
 	{
-		//Process alpha timer
-		if (this.m_tmrAlpha.IsActive()) {
-			this.m_tmrAlpha.Update();
-			if (this.m_tmrAlpha.IsElapsed()) {
-				this.m_tmrAlpha.Reset();
-				this.m_ucAlpha -= 7;
-			}
+		//Fade and wobble in steps, sleeping in between. The first call only starts the delay
+		if (this.m_bStarted) {
+			this.m_ucAlpha -= 7;
+			this.m_fRotation = (Util_Random(0, 2) == 1) ? -0.1 : 0.1;
 		}
 		
+		this.m_bStarted = true;
+		
 		//Process removal timer
 		if (this.m_tmrAlive.IsActive()) {
 			this.m_tmrAlive.Update();
 		}
 		
-		//Process rotation timer
-		if (this.m_tmrRot.IsActive()) {
-			this.m_tmrRot.Update();
-			if (this.m_tmrRot.IsElapsed()) {
-				this.m_tmrRot.Reset();
-				this.m_fRotation = (Util_Random(0, 2) == 1) ? -0.1 : 0.1;
-			}
-		}
+		if (!this.m_tmrAlive.IsElapsed())
+			Ent_SetNextThink(this, HHG_STEP_DELAY);
 	}
 	
 	//Entity can draw everything in default order here
@@ -469,6 +469,7 @@ class CDecalSprite : IScriptedEntity
 	void OnProcess()
 	{
 		this.m_oLifeTime.Update();
+		Ent_SetNextThink(this, 1000);
 	}
 	
 	//Entity can draw everything in default order here
@@ -670,6 +671,7 @@ class CDamageDecal : IScriptedEntity
 }
 const int SPRITESHEET_INDEX_START = 11;
 const int SPRITESHEET_INDEX_END = 28;
+const uint FIREBALL_OFFSCREEN_REMOVE_DELAY = 3000;
 class CFireball : IScriptedEntity
 {
 	Vector m_vecPos;
@@ -849,6 +851,7 @@ void CDG_API_Process()
 			g_tmrVolley.Reset();
 			CFireball @fb = CFireball();
 			Ent_SpawnEntity(@fb, g_vecMousePos);
+			Ent_SetLodPolicy(@fb, true, FIREBALL_OFFSCREEN_REMOVE_DELAY, 1);
 		}
 
 		g_tmrShower.Update();
@@ -727,6 +727,11 @@ class CBaseRLauncher : IScriptedEntity
 		if (!this.m_bMove)
 			return;
 
+		//Follow the flow field of the move order around obstacles
+		float flFlowAngle;
+		if (Ent_GetFlowDirection(this, this.m_vecPosition, flFlowAngle))
+			this.m_flBodyRot = flFlowAngle + 6.30 / 4;
+
 		//Set next position according to view
 		this.m_vecPosition[0] += int(sin(this.m_flBodyRot + 0.014) * this.m_sRLauncherAttrs.Speed);
 		this.m_vecPosition[1] -= int(cos(this.m_flBodyRot + 0.014) * this.m_sRLauncherAttrs.Speed);